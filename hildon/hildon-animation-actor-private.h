@@ -29,6 +29,10 @@ G_BEGIN_DECLS
 
 typedef struct                                  _HildonAnimationActorPrivate HildonAnimationActorPrivate;
 
+typedef struct                                  _HildonAnimationActorKeyframe HildonAnimationActorKeyframe;
+
+#define                                         HILDON_AA_N_ATTRIBUTES (HILDON_AA_ATTR_OPACITY + 1)
+
 #define                                         HILDON_ANIMATION_ACTOR_GET_PRIVATE(obj) \
                                                 (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
                                                 HILDON_TYPE_ANIMATION_ACTOR, HildonAnimationActorPrivate));
@@ -72,8 +76,24 @@ struct                                          _HildonAnimationActorPrivate
 
     GtkWindow *parent;
     gulong     parent_map_event_cb_id;
-
     gulong     map_event_cb_id;
+
+    guint      update_depth;
+
+    /* Keyframes for each attribute, sorted by time */
+    GArray    *keyframes[HILDON_AA_N_ATTRIBUTES];
+    gdouble    timeline_start_values[HILDON_AA_N_ATTRIBUTES];
+    guint      timeline_duration;
+    gdouble    timeline_start;
+    guint      timeline_running : 1;
+    guint      timeline_loop : 1;
+};
+
+struct                                          _HildonAnimationActorKeyframe
+{
+    guint                       msecs;
+    gdouble                     value;
+    HildonAnimationActorEasing  easing;
 };
 
 G_END_DECLS
@@ -72,6 +72,13 @@
  * convenience functions for the programmer to be able to modify every
  * parameter individually.
  *
+ * When several parameters are changed at the same time (e.g, in every
+ * frame of an animation), the changes can be grouped between
+ * hildon_animation_actor_begin_update() and
+ * hildon_animation_actor_commit_update(). Only the latest value of
+ * each parameter is sent to the window manager, once, when the update
+ * is committed.
+ *
  * <example>
  * <title>Basic HildonAnimationActor example</title>
  * <programlisting>
@@ -145,14 +152,25 @@
  * </example>
  */
 
+#include                                        <math.h>
+
 #include                                        <gdk/gdkx.h>
 #include                                        <X11/Xatom.h>
 
 #include                                        "hildon-animation-actor.h"
 #include                                        "hildon-animation-actor-private.h"
+#include                                        "hildon-private.h"
 
 G_DEFINE_TYPE (HildonAnimationActor, hildon_animation_actor, GTK_TYPE_WINDOW);
 
+enum
+{
+    TIMELINE_COMPLETED,
+    LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
 static GdkFilterReturn
 hildon_animation_actor_event_filter (GdkXEvent *xevent,
                                      GdkEvent *event,
@@ -162,15 +180,16 @@ hildon_animation_actor_update_ready (HildonAnimationActor *self);
 static void
 hildon_animation_actor_send_pending_messages (HildonAnimationActor *self);
 static void
-hildon_animation_actor_send_all_messages (HildonAnimationActor *self);
+hildon_animation_actor_resend (GtkWidget *widget,
+                               HildonWMClientResendStage stage);
+static gboolean
+hildon_animation_actor_map_event (GtkWidget *widget,
+                                  GdkEvent *event,
+                                  gpointer user_data);
 static gboolean
 hildon_animation_actor_parent_map_event (GtkWidget *parent,
 					 GdkEvent *event,
 					 gpointer user_data);
-static gboolean
-hildon_animation_actor_map_event (GtkWidget *widget,
-				  GdkEvent *event,
-				  gpointer user_data);
 
 static guint32 show_atom;
 static guint32 position_atom;
@@ -182,6 +201,23 @@ static guint32 ready_atom;
 
 static gboolean atoms_initialized = FALSE;
 
+/*
+ * Messages can only be sent when the actor is mapped, the window
+ * manager is ready to process them and there's no update in progress
+ * (see hildon_animation_actor_begin_update()). Otherwise the setters
+ * only store the new values and mark them as pending.
+ */
+static gboolean
+hildon_animation_actor_can_send_messages (HildonAnimationActor *self)
+{
+    HildonAnimationActorPrivate
+	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    return GTK_WIDGET_MAPPED (GTK_WIDGET (self)) &&
+	priv->ready &&
+	priv->update_depth == 0;
+}
+
 static void
 hildon_animation_actor_realize                 (GtkWidget *widget)
 {
@@ -283,6 +319,10 @@ hildon_animation_actor_finalize                (GObject *object)
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
 
+    hildon_animation_actor_clear_keyframes (self);
+
+    hildon_private_wm_client_unregister (GTK_WIDGET (self));
+
     if (priv->parent)
     {
 	if (priv->parent_map_event_cb_id)
@@ -308,6 +348,24 @@ hildon_animation_actor_class_init              (HildonAnimationActorClass *klass
     widget_class->show              = hildon_animation_actor_show;
     widget_class->hide              = hildon_animation_actor_hide;
 
+    /**
+     * HildonAnimationActor::timeline-completed:
+     * @widget: the widget that received the signal
+     *
+     * Emitted when a timeline started with
+     * hildon_animation_actor_start_timeline() reaches its last
+     * keyframe. Looping timelines never complete.
+     *
+     * Since: 2.2
+     */
+    signals[TIMELINE_COMPLETED] =
+        g_signal_new ("timeline-completed",
+                      G_TYPE_FROM_CLASS (klass),
+                      G_SIGNAL_RUN_LAST,
+                      0, NULL, NULL,
+                      g_cclosure_marshal_VOID__VOID,
+                      G_TYPE_NONE, 0);
+
     g_type_class_add_private (klass, sizeof (HildonAnimationActorPrivate));
 }
 
@@ -322,6 +380,9 @@ hildon_animation_actor_init                    (HildonAnimationActor *self)
     priv->scale_x = 1 << 16;
     priv->scale_y = 1 << 16;
     priv->opacity = 0xff;
+
+    hildon_private_wm_client_register (GTK_WIDGET (self),
+                                       hildon_animation_actor_resend);
 }
 
 /**
@@ -423,14 +484,16 @@ hildon_animation_actor_update_ready (HildonAnimationActor *self)
     {
 	/* The ready flag has been set once already. This means that
 	 * the WM has restarted. Trigger re-mapping of the widget to
-	 * update the texture actor first. Then push all animation
-	 * actor settings anew. */
+	 * update the texture actor first. Then, once the WM has
+	 * mapped it again, push all animation actor settings anew,
+	 * together with the other actors and textures that need it. */
 
-	priv->map_event_cb_id =
-	    g_signal_connect (G_OBJECT (self),
-			      "map-event",
-			      G_CALLBACK(hildon_animation_actor_map_event),
-			      self);
+	if (priv->map_event_cb_id == 0)
+	    priv->map_event_cb_id =
+		g_signal_connect (G_OBJECT (self),
+				  "map-event",
+				  G_CALLBACK(hildon_animation_actor_map_event),
+				  self);
 
 	if (GTK_WIDGET_MAPPED (GTK_WIDGET (self)))
 	{
@@ -509,20 +572,34 @@ hildon_animation_actor_send_pending_messages (HildonAnimationActor *self)
 					      priv->show, priv->opacity);
 }
 
+/*
+ * Called by the WM client registry to send the whole state again after
+ * a WM restart. The geometry of every client is sent first, and only
+ * then the parent and visibility, so that nothing shows up in a stale
+ * place.
+ */
 static void
-hildon_animation_actor_send_all_messages (HildonAnimationActor *self)
+hildon_animation_actor_resend (GtkWidget *widget,
+                               HildonWMClientResendStage stage)
 {
+    HildonAnimationActor        *self = HILDON_ANIMATION_ACTOR (widget);
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
 
-    priv->set_anchor = 1;
-    priv->set_position = 1;
-    priv->set_rotation = (1 << HILDON_AA_X_AXIS) |
-	                 (1 << HILDON_AA_Y_AXIS) |
-	                 (1 << HILDON_AA_Z_AXIS);
-    priv->set_scale = 1;
-    priv->set_parent = 1;
-    priv->set_show = 1;
+    if (stage == HILDON_WM_CLIENT_RESEND_GEOMETRY)
+    {
+	priv->set_anchor = 1;
+	priv->set_position = 1;
+	priv->set_rotation = (1 << HILDON_AA_X_AXIS) |
+	                     (1 << HILDON_AA_Y_AXIS) |
+	                     (1 << HILDON_AA_Z_AXIS);
+	priv->set_scale = 1;
+    }
+    else
+    {
+	priv->set_parent = 1;
+	priv->set_show = 1;
+    }
 
     hildon_animation_actor_send_pending_messages (self);
 }
@@ -558,8 +635,11 @@ hildon_animation_actor_send_message (HildonAnimationActor *self,
                                      guint32 l4)
 {
     GtkWidget          *widget = GTK_WIDGET (self);
-    Display            *display = GDK_WINDOW_XDISPLAY (widget->window);
-    Window              window = GDK_WINDOW_XID (widget->window);
+    Display            *display;
+    Window              window;
+
+    display = GDK_WINDOW_XDISPLAY (widget->window);
+    window = GDK_WINDOW_XID (widget->window);
 #if 0
     XClientMessageEvent event;
 
@@ -629,7 +709,6 @@ hildon_animation_actor_set_show_full (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     if (opacity > 255)
 	opacity = 255;
@@ -641,7 +720,7 @@ hildon_animation_actor_set_show_full (HildonAnimationActor *self,
     priv->opacity = opacity;
     priv->set_show = 1;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	/* Defer show messages until the animation actor is parented
 	 * and the parent window is mapped */
@@ -744,14 +823,13 @@ hildon_animation_actor_set_position_full (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     priv->position_x = x;
     priv->position_y = y;
     priv->depth = depth;
     priv->set_position = 1;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	hildon_animation_actor_send_message (self,
 					     position_atom,
@@ -825,13 +903,12 @@ hildon_animation_actor_set_scalex (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     priv->scale_x = x_scale;
     priv->scale_y = y_scale;
     priv->set_scale = 1;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	hildon_animation_actor_send_message (self,
 					     scale_atom,
@@ -895,7 +972,6 @@ hildon_animation_actor_set_rotationx (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     guint mask = 0;
 
@@ -925,7 +1001,7 @@ hildon_animation_actor_set_rotationx (HildonAnimationActor *self,
 
     priv->set_rotation |= mask;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	hildon_animation_actor_send_message (self,
 					     rotation_atom,
@@ -991,14 +1067,13 @@ hildon_animation_actor_set_anchor (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     priv->gravity = 0;
     priv->anchor_x = x;
     priv->anchor_y = y;
     priv->set_anchor = 1;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	hildon_animation_actor_send_message (self,
 					     anchor_atom,
@@ -1040,12 +1115,11 @@ hildon_animation_actor_set_anchor_from_gravity (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     priv->gravity = gravity;
     priv->set_anchor = 1;
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	hildon_animation_actor_send_message (self,
 					     anchor_atom,
@@ -1056,40 +1130,22 @@ hildon_animation_actor_set_anchor_from_gravity (HildonAnimationActor *self,
 }
 
 /*
- * This callback will be triggered by the parent widget of
- * an animation actor when it is mapped. The compositing
- * window manager is now ready to parent the animation actor
- * into the target parent window.
- */
-static gboolean
-hildon_animation_actor_parent_map_event (GtkWidget *parent,
-					 GdkEvent *event,
-					 gpointer user_data)
-{
-    hildon_animation_actor_set_parent (HILDON_ANIMATION_ACTOR (user_data),
-				       GTK_WINDOW (parent));
-    return FALSE;
-}
-
-/*
- * This callback will be triggered by the widget re-mapping
- * itself in case of WM restarting. The point is to push all
- * animation actor parameters anew to the WM.
+ * This callback will be triggered by the first map of the
+ * animation actor after a window manager restart, once the WM has
+ * created its texture actor again.
  */
 static gboolean
 hildon_animation_actor_map_event (GtkWidget *widget,
-				  GdkEvent *event,
-				  gpointer user_data)
+                                  GdkEvent *event,
+                                  gpointer user_data)
 {
     HildonAnimationActor
 	               *self = HILDON_ANIMATION_ACTOR (user_data);
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
 
-    hildon_animation_actor_send_all_messages (self);
-
-    /* Disconnect the "map-event" handler after the "emergency resend all
-     * actor parameters" drill is over. */
+    /* Disconnect the "map-event" handler, the resend is only needed
+     * once per restart. */
 
     if (priv->map_event_cb_id)
     {
@@ -1098,6 +1154,24 @@ hildon_animation_actor_map_event (GtkWidget *widget,
 	priv->map_event_cb_id = 0;
     }
 
+    hildon_private_wm_client_queue_resend (GTK_WIDGET (self));
+
+    return FALSE;
+}
+
+/*
+ * This callback will be triggered by the parent widget of
+ * an animation actor when it is mapped. The compositing
+ * window manager is now ready to parent the animation actor
+ * into the target parent window.
+ */
+static gboolean
+hildon_animation_actor_parent_map_event (GtkWidget *parent,
+					 GdkEvent *event,
+					 gpointer user_data)
+{
+    hildon_animation_actor_set_parent (HILDON_ANIMATION_ACTOR (user_data),
+				       GTK_WINDOW (parent));
     return FALSE;
 }
 
@@ -1131,7 +1205,6 @@ hildon_animation_actor_set_parent (HildonAnimationActor *self,
 {
     HildonAnimationActorPrivate
 	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
-    GtkWidget          *widget = GTK_WIDGET (self);
 
     gtk_window_set_transient_for (GTK_WINDOW (self), parent);
 
@@ -1172,7 +1245,7 @@ hildon_animation_actor_set_parent (HildonAnimationActor *self,
 	}
     }
 
-    if (GTK_WIDGET_MAPPED (widget) && priv->ready)
+    if (hildon_animation_actor_can_send_messages (self))
     {
 	Window win = 0;
 
@@ -1218,3 +1291,496 @@ hildon_animation_actor_set_parent (HildonAnimationActor *self,
     }
 }
 
+/**
+ * hildon_animation_actor_begin_update:
+ * @self: A #HildonAnimationActor
+ *
+ * Starts a group of changes to the actor parameters. Until
+ * hildon_animation_actor_commit_update() is called, the setters only
+ * store the new values without sending any message to the window
+ * manager. If the same parameter is set several times, only the last
+ * value will be sent.
+ *
+ * Calls to this function can be nested. Messages are only sent when
+ * the outermost update is committed.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_begin_update (HildonAnimationActor *self)
+{
+    HildonAnimationActorPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    priv->update_depth++;
+}
+
+/**
+ * hildon_animation_actor_commit_update:
+ * @self: A #HildonAnimationActor
+ *
+ * Ends a group of changes started with
+ * hildon_animation_actor_begin_update(), and sends the latest value
+ * of every parameter changed since then to the window manager.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_commit_update (HildonAnimationActor *self)
+{
+    HildonAnimationActorPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    g_return_if_fail (priv->update_depth > 0);
+
+    if (--priv->update_depth == 0 &&
+	hildon_animation_actor_can_send_messages (self))
+    {
+	hildon_animation_actor_send_pending_messages (self);
+    }
+}
+
+/* ------------------------------------------------------------- */
+
+/*
+ * Keyframe timelines. All running timelines share a single clock and
+ * a single timeout; every tick samples all the active actors and only
+ * sends the parameters whose value actually changed, grouped in one
+ * update per actor.
+ */
+
+#define                                         TIMELINE_FRAME_INTERVAL 16
+
+static GList *timeline_actors = NULL;
+static GTimer *timeline_timer = NULL;
+static guint timeline_timeout_id = 0;
+
+static gdouble
+hildon_animation_actor_get_attribute (HildonAnimationActor *self,
+                                      HildonAnimationActorAttribute attribute)
+{
+    HildonAnimationActorPrivate
+	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    switch (attribute)
+    {
+	case HILDON_AA_ATTR_X:
+	    return priv->position_x;
+	case HILDON_AA_ATTR_Y:
+	    return priv->position_y;
+	case HILDON_AA_ATTR_DEPTH:
+	    return priv->depth;
+	case HILDON_AA_ATTR_SCALE_X:
+	    return priv->scale_x / (gdouble) (1 << 16);
+	case HILDON_AA_ATTR_SCALE_Y:
+	    return priv->scale_y / (gdouble) (1 << 16);
+	case HILDON_AA_ATTR_ROTATION_X:
+	    return priv->x_rotation_angle / (gdouble) (1 << 16);
+	case HILDON_AA_ATTR_ROTATION_Y:
+	    return priv->y_rotation_angle / (gdouble) (1 << 16);
+	case HILDON_AA_ATTR_ROTATION_Z:
+	    return priv->z_rotation_angle / (gdouble) (1 << 16);
+	case HILDON_AA_ATTR_OPACITY:
+	    return priv->opacity;
+	default:
+	    g_assert_not_reached ();
+    }
+
+    return 0;
+}
+
+static gdouble
+hildon_animation_actor_ease (HildonAnimationActorEasing easing,
+                             gdouble p)
+{
+    switch (easing)
+    {
+	case HILDON_AA_EASE_IN:
+	    return p * p;
+	case HILDON_AA_EASE_OUT:
+	    return p * (2 - p);
+	case HILDON_AA_EASE_IN_OUT:
+	    if (p < 0.5)
+		return 2 * p * p;
+	    return -1 + (4 - 2 * p) * p;
+	case HILDON_AA_EASE_LINEAR:
+	default:
+	    return p;
+    }
+}
+
+/* Value of an attribute @msecs after the start of the timeline. The
+ * value at time 0 is the one the attribute had when the timeline was
+ * started, unless there's a keyframe for it. */
+static gdouble
+hildon_animation_actor_sample (GArray *keyframes,
+                               gdouble start_value,
+                               gdouble msecs)
+{
+    HildonAnimationActorKeyframe *next = NULL;
+    guint prev_msecs = 0;
+    gdouble prev_value = start_value;
+    gdouble p;
+    guint i;
+
+    for (i = 0; i < keyframes->len; i++)
+    {
+	next = &g_array_index (keyframes, HildonAnimationActorKeyframe, i);
+
+	if (next->msecs >= msecs)
+	    break;
+
+	prev_msecs = next->msecs;
+	prev_value = next->value;
+    }
+
+    if (i == keyframes->len)
+	return prev_value;
+
+    if (next->msecs == prev_msecs)
+	return next->value;
+
+    p = (msecs - prev_msecs) / (next->msecs - prev_msecs);
+
+    return prev_value +
+	(next->value - prev_value) * hildon_animation_actor_ease (next->easing, p);
+}
+
+static void
+hildon_animation_actor_timeline_apply (HildonAnimationActor *self,
+                                       gdouble msecs)
+{
+    HildonAnimationActorPrivate
+	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+    gint values[HILDON_AA_N_ATTRIBUTES];
+    gint i;
+
+    for (i = 0; i < HILDON_AA_N_ATTRIBUTES; i++)
+    {
+	gdouble value = priv->timeline_start_values[i];
+
+	if (priv->keyframes[i] != NULL)
+	    value = hildon_animation_actor_sample (priv->keyframes[i],
+						   value, msecs);
+
+	/* Scales and angles are sent as 16.16 fixed point numbers */
+	if (i >= HILDON_AA_ATTR_SCALE_X && i <= HILDON_AA_ATTR_ROTATION_Z)
+	    value *= (1 << 16);
+
+	values[i] = (gint) floor (value + 0.5);
+    }
+
+    hildon_animation_actor_begin_update (self);
+
+    if (values[HILDON_AA_ATTR_X] != priv->position_x ||
+	values[HILDON_AA_ATTR_Y] != priv->position_y ||
+	values[HILDON_AA_ATTR_DEPTH] != priv->depth)
+	hildon_animation_actor_set_position_full (self,
+						  values[HILDON_AA_ATTR_X],
+						  values[HILDON_AA_ATTR_Y],
+						  values[HILDON_AA_ATTR_DEPTH]);
+
+    if (values[HILDON_AA_ATTR_SCALE_X] != priv->scale_x ||
+	values[HILDON_AA_ATTR_SCALE_Y] != priv->scale_y)
+	hildon_animation_actor_set_scalex (self,
+					   values[HILDON_AA_ATTR_SCALE_X],
+					   values[HILDON_AA_ATTR_SCALE_Y]);
+
+    if (values[HILDON_AA_ATTR_ROTATION_X] != priv->x_rotation_angle)
+	hildon_animation_actor_set_rotationx (self,
+					      HILDON_AA_X_AXIS,
+					      values[HILDON_AA_ATTR_ROTATION_X],
+					      0,
+					      priv->x_rotation_y,
+					      priv->x_rotation_z);
+
+    if (values[HILDON_AA_ATTR_ROTATION_Y] != priv->y_rotation_angle)
+	hildon_animation_actor_set_rotationx (self,
+					      HILDON_AA_Y_AXIS,
+					      values[HILDON_AA_ATTR_ROTATION_Y],
+					      priv->y_rotation_x,
+					      0,
+					      priv->y_rotation_z);
+
+    if (values[HILDON_AA_ATTR_ROTATION_Z] != priv->z_rotation_angle)
+	hildon_animation_actor_set_rotationx (self,
+					      HILDON_AA_Z_AXIS,
+					      values[HILDON_AA_ATTR_ROTATION_Z],
+					      priv->z_rotation_x,
+					      priv->z_rotation_y,
+					      0);
+
+    if (values[HILDON_AA_ATTR_OPACITY] != priv->opacity)
+	hildon_animation_actor_set_show_full (self,
+					      priv->show,
+					      CLAMP (values[HILDON_AA_ATTR_OPACITY], 0, 255));
+
+    hildon_animation_actor_commit_update (self);
+}
+
+static gboolean
+hildon_animation_actor_timeline_tick (gpointer data)
+{
+    gdouble now = g_timer_elapsed (timeline_timer, NULL) * 1000;
+    GList *completed = NULL;
+    GList *iter, *next;
+    gboolean keep;
+
+    for (iter = timeline_actors; iter != NULL; iter = next)
+    {
+	HildonAnimationActor *self = HILDON_ANIMATION_ACTOR (iter->data);
+	HildonAnimationActorPrivate
+	               *priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+	gdouble msecs = now - priv->timeline_start;
+
+	next = iter->next;
+
+	if (msecs >= priv->timeline_duration)
+	{
+	    if (priv->timeline_loop && priv->timeline_duration > 0)
+	    {
+		msecs = fmod (msecs, priv->timeline_duration);
+		priv->timeline_start = now - msecs;
+	    }
+	    else
+	    {
+		msecs = priv->timeline_duration;
+		priv->timeline_running = FALSE;
+		timeline_actors = g_list_delete_link (timeline_actors, iter);
+		completed = g_list_prepend (completed, g_object_ref (self));
+	    }
+	}
+
+	hildon_animation_actor_timeline_apply (self, msecs);
+    }
+
+    /* Decide before emitting: a handler restarting a timeline adds a
+     * new timeout when this one is about to be dropped */
+    keep = (timeline_actors != NULL);
+    if (!keep)
+	timeline_timeout_id = 0;
+
+    /* Handlers may restart timelines, so emit the signals once the
+     * list of running actors is consistent */
+    for (iter = completed; iter != NULL; iter = iter->next)
+    {
+	g_signal_emit (iter->data, signals[TIMELINE_COMPLETED], 0);
+	g_object_unref (iter->data);
+    }
+    g_list_free (completed);
+
+    return keep;
+}
+
+/**
+ * hildon_animation_actor_add_keyframe:
+ * @self: A #HildonAnimationActor
+ * @attribute: The attribute to animate
+ * @msecs: Time of the keyframe, in milliseconds since the start of the timeline
+ * @value: Value of @attribute at @msecs
+ * @easing: How to interpolate from the previous keyframe to this one
+ *
+ * Adds a keyframe to the actor timeline. Keyframes can be added in
+ * any order. Between two keyframes, the value of @attribute is
+ * interpolated as specified by the @easing of the later one. Before
+ * the first keyframe, the value is interpolated from the one
+ * @attribute had when the timeline was started.
+ *
+ * A keyframe replaces any other keyframe for the same @attribute
+ * and @msecs. Keyframes added while the timeline is running are
+ * taken into account from the next time it is started.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_add_keyframe (HildonAnimationActor *self,
+                                     HildonAnimationActorAttribute attribute,
+                                     guint msecs,
+                                     gdouble value,
+                                     HildonAnimationActorEasing easing)
+{
+    HildonAnimationActorPrivate *priv;
+    HildonAnimationActorKeyframe keyframe;
+    GArray *keyframes;
+    guint i;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+    g_return_if_fail (attribute < HILDON_AA_N_ATTRIBUTES);
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    if (priv->keyframes[attribute] == NULL)
+	priv->keyframes[attribute] =
+	    g_array_new (FALSE, FALSE, sizeof (HildonAnimationActorKeyframe));
+
+    keyframes = priv->keyframes[attribute];
+
+    keyframe.msecs = msecs;
+    keyframe.value = value;
+    keyframe.easing = easing;
+
+    for (i = 0; i < keyframes->len; i++)
+    {
+	HildonAnimationActorKeyframe *k =
+	    &g_array_index (keyframes, HildonAnimationActorKeyframe, i);
+
+	if (k->msecs == msecs)
+	{
+	    *k = keyframe;
+	    return;
+	}
+
+	if (k->msecs > msecs)
+	    break;
+    }
+
+    g_array_insert_val (keyframes, i, keyframe);
+}
+
+/**
+ * hildon_animation_actor_clear_keyframes:
+ * @self: A #HildonAnimationActor
+ *
+ * Removes all the keyframes of the actor timeline. If the timeline
+ * is running, it is stopped.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_clear_keyframes (HildonAnimationActor *self)
+{
+    HildonAnimationActorPrivate *priv;
+    gint i;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    hildon_animation_actor_stop_timeline (self);
+
+    for (i = 0; i < HILDON_AA_N_ATTRIBUTES; i++)
+    {
+	if (priv->keyframes[i] != NULL)
+	{
+	    g_array_free (priv->keyframes[i], TRUE);
+	    priv->keyframes[i] = NULL;
+	}
+    }
+}
+
+/**
+ * hildon_animation_actor_start_timeline:
+ * @self: A #HildonAnimationActor
+ * @loop: Whether to restart the timeline when it reaches the last keyframe
+ *
+ * Starts animating the actor with the keyframes added with
+ * hildon_animation_actor_add_keyframe(). The attributes are computed
+ * on the client side, in sync with all the other running timelines,
+ * and only the ones that changed in each frame are sent to the window
+ * manager. If the timeline was already running, it is restarted.
+ *
+ * Unless @loop is %TRUE, the timeline stops after the last keyframe
+ * and #HildonAnimationActor::timeline-completed is emitted.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_start_timeline (HildonAnimationActor *self,
+                                       gboolean loop)
+{
+    HildonAnimationActorPrivate *priv;
+    gint i;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    hildon_animation_actor_stop_timeline (self);
+
+    priv->timeline_duration = 0;
+    for (i = 0; i < HILDON_AA_N_ATTRIBUTES; i++)
+    {
+	GArray *keyframes = priv->keyframes[i];
+
+	priv->timeline_start_values[i] =
+	    hildon_animation_actor_get_attribute (self, i);
+
+	if (keyframes != NULL && keyframes->len > 0)
+	{
+	    guint last = g_array_index (keyframes, HildonAnimationActorKeyframe,
+					keyframes->len - 1).msecs;
+	    priv->timeline_duration = MAX (priv->timeline_duration, last);
+	}
+    }
+
+    if (timeline_timer == NULL)
+	timeline_timer = g_timer_new ();
+
+    priv->timeline_start = g_timer_elapsed (timeline_timer, NULL) * 1000;
+    priv->timeline_loop = (loop != FALSE);
+    priv->timeline_running = TRUE;
+
+    timeline_actors = g_list_prepend (timeline_actors, self);
+
+    if (timeline_timeout_id == 0)
+	timeline_timeout_id =
+	    gdk_threads_add_timeout (TIMELINE_FRAME_INTERVAL,
+				     hildon_animation_actor_timeline_tick,
+				     NULL);
+}
+
+/**
+ * hildon_animation_actor_stop_timeline:
+ * @self: A #HildonAnimationActor
+ *
+ * Stops the actor timeline, leaving the attributes at their current
+ * values. #HildonAnimationActor::timeline-completed is not emitted.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_animation_actor_stop_timeline (HildonAnimationActor *self)
+{
+    HildonAnimationActorPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_ANIMATION_ACTOR (self));
+
+    priv = HILDON_ANIMATION_ACTOR_GET_PRIVATE (self);
+
+    if (!priv->timeline_running)
+	return;
+
+    priv->timeline_running = FALSE;
+    timeline_actors = g_list_remove (timeline_actors, self);
+
+    if (timeline_actors == NULL && timeline_timeout_id != 0)
+    {
+	g_source_remove (timeline_timeout_id);
+	timeline_timeout_id = 0;
+    }
+}
+
+/**
+ * hildon_animation_actor_is_timeline_running:
+ * @self: A #HildonAnimationActor
+ *
+ * Returns whether the actor timeline is running.
+ *
+ * Return value: %TRUE if the timeline was started and hasn't completed
+ * or been stopped yet.
+ *
+ * Since: 2.2
+ **/
+gboolean
+hildon_animation_actor_is_timeline_running (HildonAnimationActor *self)
+{
+    g_return_val_if_fail (HILDON_IS_ANIMATION_ACTOR (self), FALSE);
+
+    return HILDON_ANIMATION_ACTOR_GET_PRIVATE (self)->timeline_running;
+}
@@ -88,6 +88,49 @@ struct                                          _HildonAnimationActor
 #define HILDON_AA_NW_GRAVITY	    8
 #define HILDON_AA_CENTER_GRAVITY    9
 
+/**
+ * HildonAnimationActorAttribute:
+ * @HILDON_AA_ATTR_X: horizontal position, in pixels
+ * @HILDON_AA_ATTR_Y: vertical position, in pixels
+ * @HILDON_AA_ATTR_DEPTH: depth (z-coordinate)
+ * @HILDON_AA_ATTR_SCALE_X: horizontal scale factor
+ * @HILDON_AA_ATTR_SCALE_Y: vertical scale factor
+ * @HILDON_AA_ATTR_ROTATION_X: rotation around the X axis, in degrees
+ * @HILDON_AA_ATTR_ROTATION_Y: rotation around the Y axis, in degrees
+ * @HILDON_AA_ATTR_ROTATION_Z: rotation around the Z axis, in degrees
+ * @HILDON_AA_ATTR_OPACITY: opacity, from 0 to 255
+ *
+ * Actor attributes that can be animated with keyframes. See
+ * hildon_animation_actor_add_keyframe().
+ **/
+typedef enum {
+    HILDON_AA_ATTR_X,
+    HILDON_AA_ATTR_Y,
+    HILDON_AA_ATTR_DEPTH,
+    HILDON_AA_ATTR_SCALE_X,
+    HILDON_AA_ATTR_SCALE_Y,
+    HILDON_AA_ATTR_ROTATION_X,
+    HILDON_AA_ATTR_ROTATION_Y,
+    HILDON_AA_ATTR_ROTATION_Z,
+    HILDON_AA_ATTR_OPACITY
+} HildonAnimationActorAttribute;
+
+/**
+ * HildonAnimationActorEasing:
+ * @HILDON_AA_EASE_LINEAR: constant speed
+ * @HILDON_AA_EASE_IN: start slowly and accelerate
+ * @HILDON_AA_EASE_OUT: start fast and decelerate
+ * @HILDON_AA_EASE_IN_OUT: accelerate, then decelerate
+ *
+ * Interpolation used to reach a keyframe from the previous one.
+ **/
+typedef enum {
+    HILDON_AA_EASE_LINEAR,
+    HILDON_AA_EASE_IN,
+    HILDON_AA_EASE_OUT,
+    HILDON_AA_EASE_IN_OUT
+} HildonAnimationActorEasing;
+
 GType
 hildon_animation_actor_get_type                (void) G_GNUC_CONST;
 
@@ -157,6 +200,32 @@ void
 hildon_animation_actor_set_parent (HildonAnimationActor *self,
 				   GtkWindow *parent);
 
+void
+hildon_animation_actor_begin_update (HildonAnimationActor *self);
+
+void
+hildon_animation_actor_commit_update (HildonAnimationActor *self);
+
+void
+hildon_animation_actor_add_keyframe (HildonAnimationActor *self,
+                                     HildonAnimationActorAttribute attribute,
+                                     guint msecs,
+                                     gdouble value,
+                                     HildonAnimationActorEasing easing);
+
+void
+hildon_animation_actor_clear_keyframes (HildonAnimationActor *self);
+
+void
+hildon_animation_actor_start_timeline (HildonAnimationActor *self,
+                                       gboolean loop);
+
+void
+hildon_animation_actor_stop_timeline (HildonAnimationActor *self);
+
+gboolean
+hildon_animation_actor_is_timeline_running (HildonAnimationActor *self);
+
 G_END_DECLS
 
 #endif                                 /* __HILDON_ANIMATION_ACTOR_H__ */
@@ -41,6 +41,7 @@ struct                                          _HildonAppMenuPrivate
     gint width_request;
     guint find_intruder_idle_id;
     guint hide_idle_id;
+    guint repack_idle_id;
 };
 
 void G_GNUC_INTERNAL
@@ -107,8 +107,10 @@
 #include                                        "hildon-animation-actor.h"
 
 static void
-hildon_app_menu_repack_items                    (HildonAppMenu *menu,
-                                                 gint           start_from);
+hildon_app_menu_repack_items                    (HildonAppMenu *menu);
+
+static void
+hildon_app_menu_queue_repack_items              (HildonAppMenu *menu);
 
 static void
 hildon_app_menu_repack_filters                  (HildonAppMenu *menu);
@@ -195,7 +197,7 @@ hildon_app_menu_insert                          (HildonAppMenu *menu,
     g_object_ref_sink (item);
     priv->buttons = g_list_insert (priv->buttons, item, position);
     if (GTK_WIDGET_VISIBLE (item))
-        hildon_app_menu_repack_items (menu, position);
+        hildon_app_menu_queue_repack_items (menu);
 
     /* Enable accelerators */
     g_signal_connect (item, "can-activate-accel", G_CALLBACK (can_activate_accel), NULL);
@@ -274,7 +276,7 @@ hildon_app_menu_reorder_child                   (HildonAppMenu *menu,
     priv->buttons = g_list_remove (priv->buttons, item);
     priv->buttons = g_list_insert (priv->buttons, item, position);
 
-    hildon_app_menu_repack_items (menu, MIN (old_position, position));
+    hildon_app_menu_queue_repack_items (menu);
 }
 
 /**
@@ -334,7 +336,7 @@ hildon_app_menu_set_columns                     (HildonAppMenu *menu,
 
     if (columns != priv->columns) {
         priv->columns = columns;
-        hildon_app_menu_repack_items (menu, 0);
+        hildon_app_menu_queue_repack_items (menu);
     }
 }
 
@@ -424,7 +426,7 @@ item_visibility_changed                         (GtkWidget     *item,
     HildonAppMenuPrivate *priv = HILDON_APP_MENU_GET_PRIVATE (menu);
 
     if (! priv->inhibit_repack)
-        hildon_app_menu_repack_items (menu, g_list_index (priv->buttons, item));
+        hildon_app_menu_queue_repack_items (menu);
     g_signal_emit (menu, app_menu_signals[CHANGED], 0);
 }
 
@@ -468,7 +470,7 @@ hildon_app_menu_show_all                        (GtkWidget *widget)
 
     priv->inhibit_repack = FALSE;
 
-    hildon_app_menu_repack_items (menu, 0);
+    hildon_app_menu_queue_repack_items (menu);
     hildon_app_menu_repack_filters (menu);
 }
 
@@ -487,7 +489,7 @@ hildon_app_menu_hide_all                        (GtkWidget *widget)
 
     priv->inhibit_repack = FALSE;
 
-    hildon_app_menu_repack_items (menu, 0);
+    hildon_app_menu_queue_repack_items (menu);
     hildon_app_menu_repack_filters (menu);
 }
 
@@ -504,33 +506,57 @@ hildon_app_menu_find_intruder                   (gpointer data)
     priv->find_intruder_idle_id = 0;
 
     /* If there's a modal window between the menu and its parent window, hide the menu */
-    if (priv->parent_window) {
+    if (priv->parent_window && GTK_WIDGET (priv->parent_window)->window) {
         gboolean intruder_found = FALSE;
-        GdkScreen *screen = gtk_widget_get_screen (widget);
-        GList *stack = gdk_screen_get_window_stack (screen);
-        GList *parent_pos = g_list_find (stack, GTK_WIDGET (priv->parent_window)->window);
+        GdkWindow *parent_gdkwin = GTK_WIDGET (priv->parent_window)->window;
+        GHashTable *candidates = NULL;
         GList *toplevels = gtk_window_list_toplevels ();
         GList *i;
 
-        for (i = toplevels; i != NULL && !intruder_found; i = i->next) {
-            if (i->data != widget && i->data != priv->parent_window) {
-                if (g_list_find (parent_pos, GTK_WIDGET (i->data)->window)) {
-                    /* HildonBanners are not closed automatically when
-                     * a new window appears, so we must close them by
-                     * hand to make the AppMenu work as expected.
-                     * Yes, this is a hack. See NB#111027 */
-                    if (HILDON_IS_BANNER (i->data)) {
-                        gtk_widget_hide (i->data);
-                    } else if (GTK_IS_WINDOW (i->data)) {
-                        intruder_found = gtk_window_get_modal (i->data);
+        /* Only modal windows and banners are relevant, so check the
+         * (cheap) list of toplevels first and don't even query the
+         * window stack if there are none */
+        for (i = toplevels; i != NULL; i = i->next) {
+            GtkWidget *win = GTK_WIDGET (i->data);
+            if (win != widget && win != GTK_WIDGET (priv->parent_window) && win->window &&
+                (HILDON_IS_BANNER (win) || gtk_window_get_modal (GTK_WINDOW (win)))) {
+                if (candidates == NULL)
+                    candidates = g_hash_table_new (NULL, NULL);
+                g_hash_table_insert (candidates, win->window, win);
+            }
+        }
+        g_list_free (toplevels);
+
+        if (candidates != NULL) {
+            GdkScreen *screen = gtk_widget_get_screen (widget);
+            GList *stack = gdk_screen_get_window_stack (screen);
+            gboolean above_parent = FALSE;
+
+            /* The stack is ordered bottom to top, so everything after
+             * the parent window is above it */
+            for (i = stack; i != NULL; i = i->next) {
+                if (above_parent) {
+                    GtkWidget *win = g_hash_table_lookup (candidates, i->data);
+                    if (win != NULL) {
+                        /* HildonBanners are not closed automatically when
+                         * a new window appears, so we must close them by
+                         * hand to make the AppMenu work as expected.
+                         * Yes, this is a hack. See NB#111027 */
+                        if (HILDON_IS_BANNER (win)) {
+                            gtk_widget_hide (win);
+                        } else {
+                            intruder_found = TRUE;
+                        }
                     }
+                } else if (i->data == parent_gdkwin) {
+                    above_parent = TRUE;
                 }
+                g_object_unref (i->data);
             }
-        }
 
-        g_list_foreach (stack, (GFunc) g_object_unref, NULL);
-        g_list_free (stack);
-        g_list_free (toplevels);
+            g_list_free (stack);
+            g_hash_table_destroy (candidates);
+        }
 
         if (intruder_found)
             gtk_widget_hide (widget);
@@ -539,6 +565,21 @@ hildon_app_menu_find_intruder                   (gpointer data)
     return FALSE;
 }
 
+static void
+hildon_app_menu_show                            (GtkWidget *widget)
+{
+    HildonAppMenuPrivate *priv = HILDON_APP_MENU_GET_PRIVATE (widget);
+
+    /* Apply any pending layout change before the menu is sized */
+    if (priv->repack_idle_id) {
+        g_source_remove (priv->repack_idle_id);
+        priv->repack_idle_id = 0;
+        hildon_app_menu_repack_items (HILDON_APP_MENU (widget));
+    }
+
+    GTK_WIDGET_CLASS (hildon_app_menu_parent_class)->show (widget);
+}
+
 static void
 hildon_app_menu_map                             (GtkWidget *widget)
 {
@@ -772,54 +813,58 @@ hildon_app_menu_repack_filters                  (HildonAppMenu *menu)
 /*
  * When items displayed in the menu change (e.g, a new item is added,
  * an item is hidden or the list is reordered), the layout must be
- * updated. To do this we repack all items starting from a given one.
+ * updated. Hidden items are removed from the table, and visible items
+ * are only moved if their position in the table has changed.
  */
 static void
-hildon_app_menu_repack_items                    (HildonAppMenu *menu,
-                                                 gint           start_from)
+hildon_app_menu_repack_items                    (HildonAppMenu *menu)
 {
     HildonAppMenuPrivate *priv;
-    gint row, col, nvisible, i;
+    gint row, col, nvisible, nrows;
+    gboolean items_removed = FALSE;
     GList *iter;
 
     priv = HILDON_APP_MENU_GET_PRIVATE(menu);
 
-    i = nvisible = 0;
+    /* Remove hidden buttons from the table */
+    nvisible = 0;
     for (iter = priv->buttons; iter != NULL; iter = iter->next) {
-        /* Count number of visible items */
-        if (GTK_WIDGET_VISIBLE (iter->data))
+        GtkWidget *item = GTK_WIDGET (iter->data);
+        if (GTK_WIDGET_VISIBLE (item)) {
             nvisible++;
-        /* Remove buttons from their parent */
-        if (start_from != -1 && i >= start_from) {
-            GtkWidget *item = GTK_WIDGET (iter->data);
+        } else {
             GtkWidget *parent = gtk_widget_get_parent (item);
             if (parent) {
                 g_object_ref (item);
                 gtk_container_remove (GTK_CONTAINER (parent), item);
+                items_removed = TRUE;
             }
         }
-        i++;
     }
 
-    /* If items have been removed, recalculate the size of the menu */
-    if (start_from != -1)
-        gtk_window_resize (GTK_WINDOW (menu), 1, 1);
-
-    /* Set the final size now to avoid unnecessary resizes later */
-    if (nvisible > 0)
-        gtk_table_resize (priv->table, ((nvisible - 1) / priv->columns) + 1, priv->columns);
-
-    /* Add buttons */
+    /* Attach new buttons and move the ones whose position changed */
     row = col = 0;
     for (iter = priv->buttons; iter != NULL; iter = iter->next) {
         GtkWidget *item = GTK_WIDGET (iter->data);
         if (GTK_WIDGET_VISIBLE (item)) {
-            /* Don't add an item to the table if it's already there */
-            if (gtk_widget_get_parent (item) == NULL) {
+            GtkWidget *parent = gtk_widget_get_parent (item);
+            if (parent == NULL) {
                 gtk_table_attach_defaults (priv->table, item, col, col + 1, row, row + 1);
                 g_object_unref (item);
                 /* GtkButton must be realized for accelerators to work */
                 gtk_widget_realize (item);
+            } else {
+                guint left, top;
+                gtk_container_child_get (GTK_CONTAINER (parent), item,
+                                         "left-attach", &left,
+                                         "top-attach", &top, NULL);
+                if (left != (guint) col || top != (guint) row) {
+                    gtk_container_child_set (GTK_CONTAINER (parent), item,
+                                             "left-attach", col,
+                                             "right-attach", col + 1,
+                                             "top-attach", row,
+                                             "bottom-attach", row + 1, NULL);
+                }
             }
             if (++col == priv->columns) {
                 col = 0;
@@ -828,9 +873,48 @@ hildon_app_menu_repack_items                    (HildonAppMenu *menu,
         }
     }
 
+    /* Set the final size of the table */
+    nrows = nvisible > 0 ? ((nvisible - 1) / priv->columns) + 1 : 1;
+    if (nrows < priv->table->nrows || priv->columns < priv->table->ncols)
+        items_removed = TRUE;
+    gtk_table_resize (priv->table, nrows, priv->columns);
+
+    /* If the table has shrunk, recalculate the size of the menu */
+    if (items_removed)
+        gtk_window_resize (GTK_WINDOW (menu), 1, 1);
+
     gtk_widget_queue_draw (GTK_WIDGET (menu));
 }
 
+static gboolean
+hildon_app_menu_repack_idle                     (gpointer data)
+{
+    HildonAppMenuPrivate *priv = HILDON_APP_MENU_GET_PRIVATE (data);
+
+    priv->repack_idle_id = 0;
+    hildon_app_menu_repack_items (HILDON_APP_MENU (data));
+
+    return FALSE;
+}
+
+/*
+ * Schedule a repack of the menu items. Several changes in a row (e.g,
+ * an application hiding a number of items when switching views) only
+ * cause one relayout, which is done before the next resize or when
+ * the menu is shown, whatever happens first.
+ */
+static void
+hildon_app_menu_queue_repack_items              (HildonAppMenu *menu)
+{
+    HildonAppMenuPrivate *priv = HILDON_APP_MENU_GET_PRIVATE (menu);
+
+    if (priv->repack_idle_id == 0) {
+        priv->repack_idle_id = gdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+                                                          hildon_app_menu_repack_idle,
+                                                          menu, NULL);
+    }
+}
+
 /**
  * hildon_app_menu_has_visible_children:
  * @menu: a #HildonAppMenu
@@ -952,6 +1036,7 @@ hildon_app_menu_init                            (HildonAppMenu *menu)
     priv->width_request = -1;
     priv->find_intruder_idle_id = 0;
     priv->hide_idle_id = 0;
+    priv->repack_idle_id = 0;
 
     /* Create boxes and tables */
     priv->filters_hbox = GTK_BOX (gtk_hbox_new (TRUE, 0));
@@ -1011,6 +1096,11 @@ hildon_app_menu_finalize                        (GObject *object)
         priv->hide_idle_id = 0;
     }
 
+    if (priv->repack_idle_id) {
+        g_source_remove (priv->repack_idle_id);
+        priv->repack_idle_id = 0;
+    }
+
     if (priv->parent_window) {
         g_signal_handlers_disconnect_by_func (priv->parent_window, parent_window_topmost_notify, object);
         g_signal_handlers_disconnect_by_func (priv->parent_window, parent_window_unmapped, object);
@@ -1039,6 +1129,7 @@ hildon_app_menu_class_init                      (HildonAppMenuClass *klass)
     gobject_class->finalize = hildon_app_menu_finalize;
     widget_class->show_all = hildon_app_menu_show_all;
     widget_class->hide_all = hildon_app_menu_hide_all;
+    widget_class->show = hildon_app_menu_show;
     widget_class->map = hildon_app_menu_map;
     widget_class->realize = hildon_app_menu_realize;
     widget_class->unrealize = hildon_app_menu_unrealize;
@@ -87,6 +87,7 @@
 #include                                        "hildon-private.h"
 #include                                        "hildon-defines.h"
 #include                                        "hildon-gtk.h"
+#include                                        "hildon-enum-types.h"
 
 /* max widths */
 
@@ -95,6 +96,9 @@
 
 #define                                         HILDON_BANNER_LABEL_MAX_PROGRESS 375 /*265*/
 
+/* Lines of wrapped text shown, the rest is cut */
+#define                                         HILDON_BANNER_LABEL_MAX_LINES 3
+
 /* default timeout */
 
 #define                                         HILDON_BANNER_DEFAULT_TIMEOUT 3000
@@ -116,7 +120,9 @@ enum
     PROP_0,
     PROP_PARENT_WINDOW, 
     PROP_IS_TIMED,
-    PROP_TIMEOUT
+    PROP_TIMEOUT,
+    PROP_UPDATE_INTERVAL,
+    PROP_UPDATE_POLICY
 };
 
 static GtkWidget*                               global_timed_banner = NULL;
@@ -136,6 +142,9 @@ hildon_banner_clear_timeout                     (HildonBanner *self);
 static void 
 hildon_banner_ensure_timeout                    (HildonBanner *self);
 
+static void
+hildon_banner_flush_text                        (HildonBanner *banner);
+
 static void 
 hildon_banner_set_property                      (GObject *object,
                                                  guint prop_id,
@@ -177,6 +186,11 @@ hildon_banner_map_event                         (GtkWidget *widget,
 static void 
 force_to_wrap_truncated                         (HildonBanner *banner);
 
+static void
+hildon_banner_label_style_set                   (GtkWidget    *label,
+                                                 GtkStyle     *previous_style,
+                                                 HildonBanner *banner);
+
 static void
 hildon_banner_realize                           (GtkWidget *widget);
 
@@ -227,6 +241,14 @@ struct                                          _HildonBannerPrivate
     const gchar *name_suffix;
     guint        timeout;
     guint        timeout_id;
+    guint        update_interval;
+    HildonBannerUpdatePolicy update_policy;
+    guint        update_id;
+    GTimeVal     last_update;
+    gchar       *pending_text;
+    PangoLayout *fit_layout;
+    gint         fit_width;
+    guint        pending_is_markup    : 1;
     guint        is_timed             : 1;
     guint        require_override_dnd : 1;
     guint        overrides_dnd        : 1;
@@ -303,6 +325,13 @@ hildon_banner_timeout                           (gpointer data)
     g_assert (HILDON_IS_BANNER (data));
 
     widget = GTK_WIDGET (data);
+
+    /* A queued text gets its own full timeout instead of being lost */
+    if (HILDON_BANNER_GET_PRIVATE (data)->update_id != 0) {
+        hildon_banner_flush_text (HILDON_BANNER (data));
+        return FALSE;
+    }
+
     g_object_ref (widget);
 
     continue_timeout = simulate_close (widget);
@@ -367,6 +396,14 @@ hildon_banner_set_property                      (GObject *object,
             priv->is_timed = g_value_get_boolean (value);
             break;
 
+        case PROP_UPDATE_INTERVAL:
+            priv->update_interval = g_value_get_uint (value);
+            break;
+
+        case PROP_UPDATE_POLICY:
+            priv->update_policy = g_value_get_enum (value);
+            break;
+
         case PROP_PARENT_WINDOW:
             window = g_value_get_object (value);         
             if (priv->parent) {
@@ -408,6 +445,14 @@ hildon_banner_get_property                      (GObject *object,
             g_value_set_boolean (value, priv->is_timed);
             break;
 
+        case PROP_UPDATE_INTERVAL:
+            g_value_set_uint (value, priv->update_interval);
+            break;
+
+        case PROP_UPDATE_POLICY:
+            g_value_set_enum (value, priv->update_policy);
+            break;
+
         case PROP_PARENT_WINDOW:
             g_value_set_object (value, gtk_window_get_transient_for (GTK_WINDOW (object)));
             break;
@@ -447,6 +492,13 @@ hildon_banner_destroy                           (GtkObject *object)
 
     (void) hildon_banner_clear_timeout (self);
 
+    /* The queued text, if any, stays in pending_text until finalize;
+     * there is no point in laying it out in a dying banner */
+    if (priv->update_id) {
+        g_source_remove (priv->update_id);
+        priv->update_id = 0;
+    }
+
     if (GTK_OBJECT_CLASS (hildon_banner_parent_class)->destroy)
         GTK_OBJECT_CLASS (hildon_banner_parent_class)->destroy (object);
 }
@@ -535,10 +587,17 @@ hildon_banner_dispose                           (GObject *object)
     HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (object);
 
     if (priv->label) {
+        g_signal_handlers_disconnect_by_func (priv->label,
+                                              G_CALLBACK (hildon_banner_label_style_set), object);
         g_object_unref (priv->label);
         priv->label = NULL;
     }
 
+    if (priv->fit_layout) {
+        g_object_unref (priv->fit_layout);
+        priv->fit_layout = NULL;
+    }
+
     G_OBJECT_CLASS (hildon_banner_parent_class)->dispose (object);
 }
 
@@ -551,6 +610,8 @@ hildon_banner_finalize                          (GObject *object)
         g_object_remove_weak_pointer(G_OBJECT (priv->parent), (gpointer) &priv->parent);
     }
 
+    g_free (priv->pending_text);
+
     G_OBJECT_CLASS (hildon_banner_parent_class)->finalize (object);
 }
 
@@ -613,7 +674,6 @@ banner_do_set_text                              (HildonBanner *banner,
                                                  gboolean      is_markup)
 {
     HildonBannerPrivate *priv;
-    GtkRequisition req;
 
     priv = HILDON_BANNER_GET_PRIVATE (banner);
 
@@ -622,57 +682,183 @@ banner_do_set_text                              (HildonBanner *banner,
     } else {
         gtk_label_set_text (GTK_LABEL (priv->label), text);
     }
-    gtk_widget_set_size_request (priv->label, -1, -1);
-    gtk_widget_size_request (priv->label, &req);
 
+    priv->fit_width = 0;
     force_to_wrap_truncated (banner);
 }
 
+/* The font of the label changed, so the text has to be measured again */
+static void
+hildon_banner_label_style_set                   (GtkWidget    *label,
+                                                 GtkStyle     *previous_style,
+                                                 HildonBanner *banner)
+{
+    HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (banner);
+
+    if (priv->fit_layout) {
+        g_object_unref (priv->fit_layout);
+        priv->fit_layout = NULL;
+    }
+
+    priv->fit_width = 0;
+}
+
 /* force to wrap truncated label by setting explicit size request
- * see N#27000 and G#329646 */
+ * see N#27000 and G#329646
+ *
+ * The text is laid out once, at the maximum available width, in a
+ * layout of our own instead of making the label negotiate its size
+ * twice. The height of the lines is taken from that same layout. */
 static void 
 force_to_wrap_truncated                         (HildonBanner *banner)
 {
-    PangoLayout *layout;
-    int lines;
-    int width;
-    int height = -1;
+    GtkLabel *label;
     PangoRectangle logical;
-    GtkRequisition requisition;
+    gint max_width;
+    gint width;
+    gint height = -1;
     HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (banner);
 
     g_return_if_fail (priv);
 
-    width = priv->is_timed ? HILDON_BANNER_LABEL_MAX_TIMED
+    label = GTK_LABEL (priv->label);
+    max_width = priv->is_timed ? HILDON_BANNER_LABEL_MAX_TIMED
         : HILDON_BANNER_LABEL_MAX_PROGRESS;
 
-    /* Force the label to compute its layout using the maximum
-     * available width rather than its default one.
-     */
-    gtk_widget_set_size_request (priv->label, width, height);
-    gtk_widget_size_request (priv->label, &requisition);
+    /* Neither the text, the font nor the available width changed */
+    if (priv->fit_width == max_width)
+        return;
 
-    layout = gtk_label_get_layout (GTK_LABEL (priv->label));
-    pango_layout_get_extents (layout, NULL, &logical);
+    if (priv->fit_layout == NULL)
+        priv->fit_layout = gtk_widget_create_pango_layout (priv->label, NULL);
 
-    /* Now get the actual width needed by the pango layout */
+    if (gtk_label_get_use_markup (label))
+        pango_layout_set_markup (priv->fit_layout, gtk_label_get_label (label), -1);
+    else
+        pango_layout_set_text (priv->fit_layout, gtk_label_get_label (label), -1);
+
+    /* Measure with the label's own wrap mode, or the lines break at
+     * different places than the ones the label shows */
+    pango_layout_set_wrap (priv->fit_layout, gtk_label_get_line_wrap_mode (label));
+    pango_layout_set_width (priv->fit_layout, max_width * PANGO_SCALE);
+    pango_layout_get_extents (priv->fit_layout, NULL, &logical);
+
+    /* The label wraps at the actual width needed by the text, which
+     * breaks the lines at the same places */
     width = PANGO_PIXELS (logical.width);
 
-    /* If the layout has now been wrapped and exceeds 3 lines, we truncate
+    /* If the layout has been wrapped and exceeds 3 lines, we truncate
      * the rest of the label according to spec.
      */
-    lines = pango_layout_get_line_count (layout);
-    if (pango_layout_is_wrapped (layout) && lines > 3) {
-        /* This calculation assumes that the same font is used
-         * throughout the banner -- this is usually the case on maemo
-         *
-         * FIXME: Pango >= 1.20 has pango_layout_set_height().
-         */
-        height = (PANGO_PIXELS (logical.height) * 3) / lines + 1;
+    if (pango_layout_is_wrapped (priv->fit_layout) &&
+        pango_layout_get_line_count (priv->fit_layout) > HILDON_BANNER_LABEL_MAX_LINES) {
+        PangoLayoutIter *iter = pango_layout_get_iter (priv->fit_layout);
+        gint line, y1;
+
+        /* The bottom of the last line shown, with the sizes and
+         * spacing the text actually has */
+        for (line = 1; line < HILDON_BANNER_LABEL_MAX_LINES; line++)
+            pango_layout_iter_next_line (iter);
+        pango_layout_iter_get_line_yrange (iter, NULL, &y1);
+        pango_layout_iter_free (iter);
+
+        height = PANGO_PIXELS_CEIL (y1);
     }
 
     /* Set the final width/height */
     gtk_widget_set_size_request (priv->label, width, height);
+    priv->fit_width = max_width;
+}
+
+/* Shows the queued text now. Timed banners restart their timeout, so
+ * the text is shown as long as if it had been set right away. */
+static void
+hildon_banner_flush_text                        (HildonBanner *banner)
+{
+    HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (banner);
+
+    if (priv->update_id) {
+        g_source_remove (priv->update_id);
+        priv->update_id = 0;
+    }
+
+    g_get_current_time (&priv->last_update);
+
+    if (priv->pending_text != NULL) {
+        banner_do_set_text (banner, priv->pending_text, priv->pending_is_markup);
+        g_free (priv->pending_text);
+        priv->pending_text = NULL;
+
+        if (GTK_WIDGET_VISIBLE (banner))
+            reshow_banner (banner);
+
+        if (hildon_banner_clear_timeout (banner))
+            hildon_banner_ensure_timeout (banner);
+    }
+}
+
+static gboolean
+hildon_banner_update_timeout                    (gpointer data)
+{
+    HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (data);
+
+    priv->update_id = 0;
+    hildon_banner_flush_text (HILDON_BANNER (data));
+
+    return FALSE;
+}
+
+/* Keeps @text to be shown when the update interval has passed, if
+ * the banner is visible and its text was changed too recently.
+ * Returns FALSE if the text has to be shown at once instead. */
+static gboolean
+hildon_banner_queue_text                        (HildonBanner *banner,
+                                                 const gchar  *text,
+                                                 gboolean      is_markup)
+{
+    HildonBannerPrivate *priv = HILDON_BANNER_GET_PRIVATE (banner);
+    GTimeVal now;
+    gint64 elapsed;
+
+    g_get_current_time (&now);
+
+    if (priv->update_id == 0) {
+        elapsed = (gint64) (now.tv_sec - priv->last_update.tv_sec) * 1000 +
+            (now.tv_usec - priv->last_update.tv_usec) / 1000;
+
+        if (priv->update_interval == 0 || ! GTK_WIDGET_VISIBLE (banner) ||
+            elapsed < 0 || elapsed >= priv->update_interval) {
+            priv->last_update = now;
+            return FALSE;
+        }
+
+        priv->update_id = gdk_threads_add_timeout (priv->update_interval - elapsed,
+                                                   hildon_banner_update_timeout, banner);
+    }
+
+    if (priv->pending_text != NULL && priv->update_policy == HILDON_BANNER_UPDATE_MERGE) {
+        gchar *pending = priv->pending_text;
+        gchar *escaped = NULL;
+
+        /* Markup and plain text can only be shown together as markup */
+        if (is_markup && ! priv->pending_is_markup)
+            pending = escaped = g_markup_escape_text (priv->pending_text, -1);
+        else if (! is_markup && priv->pending_is_markup)
+            text = escaped = g_markup_escape_text (text, -1);
+
+        pending = g_strconcat (pending, "\n", text, NULL);
+        g_free (priv->pending_text);
+        g_free (escaped);
+
+        priv->pending_text = pending;
+        priv->pending_is_markup = priv->pending_is_markup || is_markup;
+    } else {
+        g_free (priv->pending_text);
+        priv->pending_text = g_strdup (text);
+        priv->pending_is_markup = is_markup;
+    }
+
+    return TRUE;
 }
 
 static void
@@ -809,6 +995,41 @@ hildon_banner_class_init                        (HildonBannerClass *klass)
                 10000,
                 HILDON_BANNER_DEFAULT_TIMEOUT,
                 G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+    /**
+     * HildonBanner:update-interval:
+     *
+     * The minimum time in milliseconds between two text changes of
+     * a visible banner. The texts that arrive sooner are kept and
+     * shown together when the interval has passed, according to
+     * #HildonBanner:update-policy. 0 shows every text at once.
+     *
+     * Since: 2.2
+     */
+    g_object_class_install_property (object_class, PROP_UPDATE_INTERVAL,
+            g_param_spec_uint ("update-interval",
+                "Update interval",
+                "The minimum time between two text changes of the banner",
+                0,
+                10000,
+                0,
+                G_PARAM_READWRITE));
+
+    /**
+     * HildonBanner:update-policy:
+     *
+     * What to do with the texts that arrive faster than
+     * #HildonBanner:update-interval.
+     *
+     * Since: 2.2
+     */
+    g_object_class_install_property (object_class, PROP_UPDATE_POLICY,
+            g_param_spec_enum ("update-policy",
+                "Update policy",
+                "How the texts arriving within the update interval are shown",
+                HILDON_TYPE_BANNER_UPDATE_POLICY,
+                HILDON_BANNER_UPDATE_REPLACE,
+                G_PARAM_READWRITE));
 }
 
 static void 
@@ -822,6 +1043,15 @@ hildon_banner_init                              (HildonBanner *self)
     priv->require_override_dnd = FALSE;
     priv->name_suffix = NULL;
     priv->main_item = NULL;
+    priv->update_interval = 0;
+    priv->update_policy = HILDON_BANNER_UPDATE_REPLACE;
+    priv->update_id = 0;
+    priv->last_update.tv_sec = 0;
+    priv->last_update.tv_usec = 0;
+    priv->pending_text = NULL;
+    priv->pending_is_markup = FALSE;
+    priv->fit_layout = NULL;
+    priv->fit_width = 0;
 
     /* Initialize the common layout inside banner */
     priv->alignment = gtk_alignment_new (0.5, 0.5, 0, 0);
@@ -837,6 +1067,8 @@ hildon_banner_init                              (HildonBanner *self)
     gtk_container_add (GTK_CONTAINER (priv->alignment), priv->layout);
     g_object_ref (priv->label);
     gtk_box_pack_start (GTK_BOX (priv->layout), priv->label, FALSE, FALSE, 0);
+    g_signal_connect (priv->label, "style-set",
+                      G_CALLBACK (hildon_banner_label_style_set), self);
 
     gtk_window_set_accept_focus (GTK_WINDOW (self), FALSE);
 
@@ -994,16 +1226,20 @@ hildon_banner_real_show_information             (GtkWidget *widget,
     banner = hildon_banner_get_instance_for_widget (widget, TRUE);
     priv = HILDON_BANNER_GET_PRIVATE (banner);
 
-    priv->name_suffix = "information";
-    unpack_main_widget_pack_label (banner);
-    banner_do_set_text (banner, text, FALSE);
-    hildon_banner_bind_style (banner);
-
     if (override_dnd) {
       /* so on the realize it will set the property */
       priv->require_override_dnd = TRUE;
     }
 
+    /* The banner is already showing some text, this one can wait */
+    if (hildon_banner_queue_text (banner, text, FALSE))
+        return GTK_WIDGET (banner);
+
+    priv->name_suffix = "information";
+    unpack_main_widget_pack_label (banner);
+    banner_do_set_text (banner, text, FALSE);
+    hildon_banner_bind_style (banner);
+
     /* Show the banner, since caller cannot do that */
     reshow_banner (banner);
 
@@ -1078,6 +1314,9 @@ hildon_banner_show_information_with_markup      (GtkWidget *widget,
     banner = hildon_banner_get_instance_for_widget (widget, TRUE);
     priv = HILDON_BANNER_GET_PRIVATE (banner);
 
+    if (hildon_banner_queue_text (banner, markup, TRUE))
+        return (GtkWidget *) banner;
+
     priv->name_suffix = "information";
     banner_do_set_text (banner, markup, TRUE);
     hildon_banner_bind_style (banner);
@@ -1270,6 +1509,9 @@ hildon_banner_set_text                          (HildonBanner *self,
 {
     g_return_if_fail (HILDON_IS_BANNER (self));
 
+    if (hildon_banner_queue_text (self, text, FALSE))
+        return;
+
     banner_do_set_text (self, text, FALSE);
 
     if (GTK_WIDGET_VISIBLE (self))
@@ -1290,6 +1532,9 @@ hildon_banner_set_markup                        (HildonBanner *self,
 {
     g_return_if_fail (HILDON_IS_BANNER (self));
 
+    if (hildon_banner_queue_text (self, markup, TRUE))
+        return;
+
     banner_do_set_text (self, markup, TRUE);
 
     if (GTK_WIDGET_VISIBLE (self))
@@ -1344,6 +1589,52 @@ hildon_banner_set_timeout                       (HildonBanner *self,
     priv->timeout = timeout;
 }
 
+/**
+ * hildon_banner_set_update_interval:
+ * @self: a #HildonBanner widget
+ * @interval: the minimum time between two text changes, in
+ * milliseconds, or 0
+ *
+ * Limits how often the text of @self changes while it is shown. When
+ * a new text is set, or a new information banner is requested for the
+ * same window, sooner than @interval after the last change, it is only
+ * shown when the interval has passed. The texts arriving meanwhile are
+ * combined according to the #HildonBanner:update-policy, so a burst of
+ * status updates is laid out and shown once.
+ *
+ * The default, 0, shows every text as soon as it is set.
+ *
+ * Since: 2.2
+ */
+void
+hildon_banner_set_update_interval               (HildonBanner *self,
+                                                 guint interval)
+{
+    g_return_if_fail (HILDON_IS_BANNER (self));
+
+    g_object_set (self, "update-interval", interval, NULL);
+}
+
+/**
+ * hildon_banner_set_update_policy:
+ * @self: a #HildonBanner widget
+ * @policy: a #HildonBannerUpdatePolicy
+ *
+ * Sets whether the texts that arrive within the update interval of
+ * @self replace each other or are shown together. See
+ * hildon_banner_set_update_interval().
+ *
+ * Since: 2.2
+ */
+void
+hildon_banner_set_update_policy                 (HildonBanner *self,
+                                                 HildonBannerUpdatePolicy policy)
+{
+    g_return_if_fail (HILDON_IS_BANNER (self));
+
+    g_object_set (self, "update-policy", policy, NULL);
+}
+
 /**
  * hildon_banner_set_icon:
  * @self: a #HildonBanner widget
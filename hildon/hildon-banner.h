@@ -42,6 +42,23 @@ G_BEGIN_DECLS
 
 typedef struct                                  _HildonBanner HildonBanner;
 
+/**
+ * HildonBannerUpdatePolicy:
+ * @HILDON_BANNER_UPDATE_REPLACE: Only the last of the texts that
+ * arrive within the update interval is shown
+ * @HILDON_BANNER_UPDATE_MERGE: The texts that arrive within the update
+ * interval are shown together, one per line
+ *
+ * Used to choose what a #HildonBanner does with the texts that arrive
+ * faster than its #HildonBanner:update-interval.
+ *
+ * Since: 2.2
+ */
+typedef enum {
+    HILDON_BANNER_UPDATE_REPLACE,
+    HILDON_BANNER_UPDATE_MERGE
+} HildonBannerUpdatePolicy;
+
 typedef struct                                  _HildonBannerClass HildonBannerClass;
 
 struct                                          _HildonBanner
@@ -115,6 +132,14 @@ void
 hildon_banner_set_timeout                       (HildonBanner *self,
                                                  guint timeout);
 
+void
+hildon_banner_set_update_interval               (HildonBanner *self,
+                                                 guint interval);
+
+void
+hildon_banner_set_update_policy                 (HildonBanner *self,
+                                                 HildonBannerUpdatePolicy policy);
+
 GtkWidget *
 hildon_banner_show_custom_widget                (GtkWidget *widget,
                                                  GtkWidget *custom_widget);
@@ -34,6 +34,29 @@ G_BEGIN_DECLS
 
 typedef struct                                  _HildonCalendarPrivate HildonCalendarPrivate;
 
+/* Days go from 1 to 31 and week numbers from 1 to 53 */
+#define                                         HILDON_CALENDAR_MAX_NUMBER 53
+
+/* The shown month and the ones before and after it */
+#define                                         HILDON_CALENDAR_N_PRERENDERED 3
+
+typedef struct                                  _HildonCalendarMonthPixmap HildonCalendarMonthPixmap;
+
+/* A month rendered off-screen, and the state it was rendered in */
+struct                                          _HildonCalendarMonthPixmap
+{
+    GdkPixmap *pixmap;
+    gint year;
+    gint month;
+    gint selected_day;
+    gint focus_row;
+    gint focus_col;
+    gboolean has_focus;
+    gint current_year;
+    gint current_month;
+    gint current_day;
+};
+
 struct                                          _HildonCalendarPrivate
 {
     GdkWindow *header_win;
@@ -69,6 +92,7 @@ struct                                          _HildonCalendarPrivate
 
     /* flags */
     guint dirty_header : 1;
+    guint dirty_footer : 1;
     guint dirty_day_names : 1;
     guint dirty_main : 1;
     guint dirty_week : 1;
@@ -80,6 +104,9 @@ struct                                          _HildonCalendarPrivate
     guint in_drag : 1;
     guint drag_highlight : 1;
 
+    guint prerender_months : 1;
+    guint slide_months : 1;
+
     guint32 timer;
     gint click_child;
 
@@ -114,6 +141,28 @@ struct                                          _HildonCalendarPrivate
 
     char *abbreviated_dayname[7];
     char *monthname[12];
+
+    /* Layouts for the day and week numbers, created on demand for the
+     * current style */
+    PangoLayout *number_layout[HILDON_CALENDAR_MAX_NUMBER];
+    PangoRectangle number_extents[HILDON_CALENDAR_MAX_NUMBER];
+
+    /* Marked days of every year, as an array of 12 bitsets (bit n for
+     * day n + 1) indexed by the year. The marked_date array of the
+     * calendar is the view of the month being shown. */
+    GHashTable *marks;
+
+    /* Months rendered at idle time, so that changing to them is a copy
+     * from a pixmap */
+    HildonCalendarMonthPixmap prerendered[HILDON_CALENDAR_N_PRERENDERED];
+    guint prerender_id;
+
+    /* Slide transition between two months */
+    GdkPixmap *slide_from;
+    GdkPixmap *slide_to;
+    gint slide_direction;
+    GTimeVal slide_start;
+    guint slide_id;
 };
 
 G_END_DECLS
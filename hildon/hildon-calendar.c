@@ -292,6 +292,10 @@ dates_difference                                (N_int year1,
 
 #define                                         CALENDAR_TIMER_DELAY            20
 
+#define                                         CALENDAR_SLIDE_DURATION         200
+
+#define                                         CALENDAR_SLIDE_FRAME_INTERVAL   16
+
 enum {
     ARROW_YEAR_LEFT,
     ARROW_YEAR_RIGHT,
@@ -331,6 +335,8 @@ enum
     PROP_WEEK_START,
     PROP_MIN_YEAR,
     PROP_MAX_YEAR,
+    PROP_PRERENDER_MONTHS,
+    PROP_SLIDE_MONTHS,
     PROP_LAST
 };
 
@@ -445,6 +451,20 @@ hildon_calendar_paint_week_numbers              (GtkWidget *widget);
 static void 
 hildon_calendar_paint_main                      (GtkWidget *widget);
 
+static void
+hildon_calendar_paint_main_region               (GtkWidget *widget,
+                                                 GdkRegion *region);
+
+static void
+hildon_calendar_invalidate_prerendered          (HildonCalendar *calendar);
+
+static void
+hildon_calendar_begin_slide                     (HildonCalendar *calendar,
+                                                 gint direction);
+
+static void
+hildon_calendar_stop_slide                      (HildonCalendar *calendar);
+
 static void 
 hildon_calendar_select_and_focus_day            (HildonCalendar *calendar,
                                                  guint day);
@@ -462,6 +482,17 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
                                                  gint row,
                                                  gint col);
 
+static void
+hildon_calendar_paint_day_on                    (GtkWidget *widget,
+                                                 GdkDrawable *drawable,
+                                                 gint row,
+                                                 gint col);
+
+static PangoLayout *
+hildon_calendar_get_number_layout               (HildonCalendar *calendar,
+                                                 gint number,
+                                                 PangoRectangle **extents);
+
 static void
 hildon_calendar_compute_days                    (HildonCalendar *calendar);
 
@@ -514,6 +545,7 @@ hildon_calendar_drag_drop                       (GtkWidget *widget,
 
 static void
 hildon_calendar_check_current_date              (HildonCalendar *calendar, 
+                                                 GdkDrawable *drawable,
                                                  gint x, 
                                                  gint y);
 
@@ -784,6 +816,37 @@ hildon_calendar_class_init                      (HildonCalendarClass *class)
                 0, 10000, 0,
                 GTK_PARAM_READWRITE));
 
+    /**
+     * HildonCalendar:prerender-months:
+     *
+     * Whether to render the previous and next months off-screen when
+     * idle, so that changing to them only needs to copy a pixmap.
+     * 
+     */
+    g_object_class_install_property (gobject_class,
+            PROP_PRERENDER_MONTHS,
+            g_param_spec_boolean ("prerender-months",
+                "Prerender months",
+                "Whether to render the adjacent months off-screen",
+                FALSE,
+                GTK_PARAM_READWRITE));
+
+    /**
+     * HildonCalendar:slide-months:
+     *
+     * Whether to slide the days of a prerendered month in when moving
+     * to it. It has no effect unless #HildonCalendar:prerender-months
+     * is set.
+     * 
+     */
+    g_object_class_install_property (gobject_class,
+            PROP_SLIDE_MONTHS,
+            g_param_spec_boolean ("slide-months",
+                "Slide months",
+                "Whether to slide prerendered months in",
+                FALSE,
+                GTK_PARAM_READWRITE));
+
     hildon_calendar_signals[MONTH_CHANGED_SIGNAL] =
         g_signal_new ("month_changed",
                 G_OBJECT_CLASS_TYPE (gobject_class),
@@ -951,6 +1014,7 @@ hildon_calendar_init                            (HildonCalendar *calendar)
     private_data->freeze_count = 0;
 
     private_data->dirty_header = 0;
+    private_data->dirty_footer = 0;
     private_data->dirty_day_names = 0;
     private_data->dirty_week = 0;
     private_data->dirty_main = 0;
@@ -965,6 +1029,20 @@ hildon_calendar_init                            (HildonCalendar *calendar)
     private_data->min_year = 0;
     private_data->max_year = 0;
 
+    for (i = 0; i < HILDON_CALENDAR_MAX_NUMBER; i++)
+        private_data->number_layout[i] = NULL;
+
+    private_data->marks = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+    private_data->prerender_months = FALSE;
+    private_data->slide_months = FALSE;
+    for (i = 0; i < HILDON_CALENDAR_N_PRERENDERED; i++)
+        private_data->prerendered[i].pixmap = NULL;
+    private_data->prerender_id = 0;
+    private_data->slide_from = NULL;
+    private_data->slide_to = NULL;
+    private_data->slide_id = 0;
+
     gtk_drag_dest_set (widget, 0, NULL, 0, GDK_ACTION_COPY);
     gtk_drag_dest_add_text_targets (widget);
 
@@ -1125,6 +1203,8 @@ hildon_calendar_set_month_prev                  (HildonCalendar *calendar)
     if (calendar->display_flags & HILDON_CALENDAR_NO_MONTH_CHANGE)
         return;
 
+    hildon_calendar_begin_slide (calendar, -1);
+
     if (calendar->month == 0)
     {
         if (!priv->min_year || calendar->year > priv->min_year)
@@ -1177,6 +1257,8 @@ hildon_calendar_set_month_next                  (HildonCalendar *calendar)
     if (calendar->display_flags & HILDON_CALENDAR_NO_MONTH_CHANGE)
         return;
 
+    hildon_calendar_begin_slide (calendar, 1);
+
     if (calendar->month == 11)
     {
         if (!priv->max_year || calendar->year < priv->max_year)
@@ -1720,6 +1802,8 @@ hildon_calendar_unrealize                       (GtkWidget *widget)
         gdk_window_destroy (private_data->main_win);
         private_data->main_win = NULL;      
     }
+
+    hildon_calendar_invalidate_prerendered (calendar);
     if (private_data->day_name_win)
     {
         gdk_window_set_user_data (private_data->day_name_win, NULL);
@@ -2078,6 +2162,9 @@ hildon_calendar_size_allocate                   (GtkWidget *widget,
                         private_data->week_width,
                         private_data->main_h);
         }
+
+        /* The size of the days may have changed */
+        hildon_calendar_invalidate_prerendered (calendar);
     }
 }
 
@@ -2086,13 +2173,14 @@ hildon_calendar_expose                          (GtkWidget *widget,
                                                  GdkEventExpose *event)
 {
     HildonCalendarPrivate *private_data;
+    gint i;
 
     private_data = HILDON_CALENDAR_GET_PRIVATE (widget);
 
     if (GTK_WIDGET_DRAWABLE (widget))
     {
         if (event->window == private_data->main_win)
-            hildon_calendar_paint_main (widget);
+            hildon_calendar_paint_main_region (widget, event->region);
 
         if (event->window == private_data->header_win)
             hildon_calendar_paint_header (widget);
@@ -2104,15 +2192,13 @@ hildon_calendar_expose                          (GtkWidget *widget,
 
         if (event->window == private_data->week_win) 
             hildon_calendar_paint_week_numbers (widget);
-    }
-
-    /* FIXME This appeared after 2.6 -> 2.10 migration. Without this the 
-     * arrows disappear when spinning through the calendar. Apparently, something 
-     * overdraws them somehow or the expose events go into blackhole. This is 
-     * a dirty fix... but kinda works */
 
-    hildon_calendar_paint_header (widget);
-    hildon_calendar_paint_footer (widget);
+        /* The arrows live in their own windows inside the header and
+         * footer, so they get their own expose events */
+        for (i = 0; i < 4; i++)
+            if (event->window == private_data->arrow_win[i])
+                hildon_calendar_paint_arrow (widget, i);
+    }
 
     return FALSE;
 }
@@ -2185,11 +2271,11 @@ hildon_calendar_paint_footer                    (GtkWidget *widget)
 
     if (private_data->freeze_count)
     {
-        private_data->dirty_header = 1;
+        private_data->dirty_footer = 1;
         return;
     }
 
-    private_data->dirty_header = 0;
+    private_data->dirty_footer = 0;
     gc = calendar->gc;
 
     /* Clear window */
@@ -2316,11 +2402,10 @@ hildon_calendar_paint_week_numbers              (GtkWidget *widget)
     GdkGC *gc; 
     guint row, week = 0, year;
     gint x_loc;
-    char buffer[10];
     gint y_loc;
     HildonCalendarPrivate *private_data;
     PangoLayout *layout;
-    PangoRectangle logical_rect;
+    PangoRectangle *logical_rect;
     gint focus_padding;
     gint focus_width;
 
@@ -2364,8 +2449,6 @@ hildon_calendar_paint_week_numbers              (GtkWidget *widget)
      * Write the labels
      */
 
-    layout = gtk_widget_create_pango_layout (widget, NULL);
-
     gdk_gc_set_foreground (gc, SELECTED_FG_COLOR (widget));
     gdk_draw_line(private_data->week_win, gc, 
             HILDON_DAY_WIDTH + 7,
@@ -2383,9 +2466,7 @@ hildon_calendar_paint_week_numbers              (GtkWidget *widget)
                     ((calendar->day[row][6] < 15 && row > 3 ? 1 : 0)
                      + calendar->month) % 12 + 1, calendar->day[row][6]));
 
-        g_snprintf (buffer, sizeof (buffer), "%d", week);
-        pango_layout_set_text (layout, buffer, -1); 
-        pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
+        layout = hildon_calendar_get_number_layout (calendar, week, &logical_rect);
 
         /* Hildon: draw passive focus for week */
         if (calendar->focus_row == row) 
@@ -2402,13 +2483,54 @@ hildon_calendar_paint_week_numbers              (GtkWidget *widget)
                     HILDON_DAY_HEIGHT);
         }
 
-        y_loc = private_data->day_name_h + top_y_for_row (calendar, row) + (HILDON_DAY_HEIGHT - logical_rect.height) / 2;
-        x_loc = (HILDON_DAY_WIDTH - logical_rect.width) / 2;
+        y_loc = private_data->day_name_h + top_y_for_row (calendar, row) + (HILDON_DAY_HEIGHT - logical_rect->height) / 2;
+        x_loc = (HILDON_DAY_WIDTH - logical_rect->width) / 2;
 
         gdk_draw_layout (private_data->week_win, gc, x_loc, y_loc, layout);
     }
+}
+
+/* Returns the cached layout for @number, with its pixel extents */
+static PangoLayout *
+hildon_calendar_get_number_layout               (HildonCalendar *calendar,
+                                                 gint number,
+                                                 PangoRectangle **extents)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    gint i = number - 1;
+
+    g_return_val_if_fail (number >= 1 && number <= HILDON_CALENDAR_MAX_NUMBER, NULL);
+
+    if (private_data->number_layout[i] == NULL)
+    {
+        gchar buffer[8];
+
+        g_snprintf (buffer, sizeof (buffer), "%d", number);
+        private_data->number_layout[i] =
+            gtk_widget_create_pango_layout (GTK_WIDGET (calendar), buffer);
+        pango_layout_get_pixel_extents (private_data->number_layout[i], NULL,
+                                        &private_data->number_extents[i]);
+    }
 
-    g_object_unref (layout);
+    *extents = &private_data->number_extents[i];
+
+    return private_data->number_layout[i];
+}
+
+static void
+hildon_calendar_clear_number_layouts            (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    gint i;
+
+    for (i = 0; i < HILDON_CALENDAR_MAX_NUMBER; i++)
+    {
+        if (private_data->number_layout[i])
+        {
+            g_object_unref (private_data->number_layout[i]);
+            private_data->number_layout[i] = NULL;
+        }
+    }
 }
 
 static void
@@ -2446,24 +2568,11 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
                                                  gint row,
                                                  gint col)
 {
-    HildonCalendar *calendar;
-    GdkGC *gc;
-    gchar buffer[255];
-    gint day;
-    gint x_left;
-    gint x_loc;
-    gint y_top;
-    gint y_loc;
-    gint focus_width;
-
     HildonCalendarPrivate *private_data;
-    PangoLayout *layout;
-    PangoRectangle logical_rect;
 
     g_return_if_fail (HILDON_IS_CALENDAR (widget));
     g_return_if_fail (row < 6);
     g_return_if_fail (col < 7);
-    calendar = HILDON_CALENDAR (widget);
     private_data = HILDON_CALENDAR_GET_PRIVATE (widget);
 
     if (private_data->main_win == NULL) return;
@@ -2478,14 +2587,41 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
         return;
     }
 
+    hildon_calendar_paint_day_on (widget, private_data->main_win, row, col);
+}
+
+static void
+hildon_calendar_paint_day_on                    (GtkWidget *widget,
+                                                 GdkDrawable *drawable,
+                                                 gint row,
+                                                 gint col)
+{
+    HildonCalendar *calendar;
+    GdkGC *gc;
+    gint day;
+    gint x_left;
+    gint x_loc;
+    gint y_top;
+    gint y_loc;
+    gint focus_width;
+
+    HildonCalendarPrivate *private_data;
+    PangoLayout *layout;
+    PangoRectangle *logical_rect;
+
+    calendar = HILDON_CALENDAR (widget);
+    private_data = HILDON_CALENDAR_GET_PRIVATE (widget);
+
     gtk_widget_style_get (widget, "focus-line-width", &focus_width, NULL);
 
     day = calendar->day[row][col];
     x_left = left_x_for_column (calendar, col);
     y_top = top_y_for_row (calendar, row);
 
-    gdk_window_clear_area (private_data->main_win, x_left, y_top,
-            HILDON_DAY_WIDTH, HILDON_DAY_HEIGHT);
+    /* Pixmaps are filled with the background before painting the days */
+    if (drawable == GDK_DRAWABLE (private_data->main_win))
+        gdk_window_clear_area (private_data->main_win, x_left, y_top,
+                HILDON_DAY_WIDTH, HILDON_DAY_HEIGHT);
 
     gc = calendar->gc;
 
@@ -2503,7 +2639,7 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
         {
             /* Hildon: use custom graphics */
             gtk_paint_box(GTK_WIDGET (calendar)->style,
-                    private_data->main_win,
+                    drawable,
                     GTK_STATE_NORMAL,
                     GTK_SHADOW_NONE, NULL,
                     GTK_WIDGET (calendar), "active-day",
@@ -2533,7 +2669,7 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
             state = GTK_STATE_NORMAL;
 
         gtk_paint_focus (widget->style, 
-                private_data->main_win,
+                drawable,
                 (calendar->selected_day == day) 
                 ? GTK_STATE_SELECTED : GTK_STATE_NORMAL, 
                 NULL, widget, "calendar-day",
@@ -2545,34 +2681,479 @@ hildon_calendar_paint_day                       (GtkWidget *widget,
     /* Hildon: paint green indicator for current day */
     if ((day == private_data->current_day && calendar->selected_day !=
                 private_data->current_day) && (calendar->day_month[row][col] == MONTH_CURRENT))
-        hildon_calendar_check_current_date (calendar, x_left, y_top);
+        hildon_calendar_check_current_date (calendar, drawable, x_left, y_top);
 
-    g_snprintf (buffer, sizeof (buffer), "%d", day);
-    layout = gtk_widget_create_pango_layout (widget, buffer);
-    pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
+    layout = hildon_calendar_get_number_layout (calendar, day, &logical_rect);
 
-    x_loc = x_left + (HILDON_DAY_WIDTH - logical_rect.width) / 2;
-    y_loc = y_top + (HILDON_DAY_HEIGHT - logical_rect.height) / 2;
+    x_loc = x_left + (HILDON_DAY_WIDTH - logical_rect->width) / 2;
+    y_loc = y_top + (HILDON_DAY_HEIGHT - logical_rect->height) / 2;
 
-    gdk_draw_layout (private_data->main_win, gc,
+    gdk_draw_layout (drawable, gc,
             x_loc, y_loc, layout);
     if (calendar->marked_date[day-1] &&
             calendar->day_month[row][col] == MONTH_CURRENT)
-        gdk_draw_layout (private_data->main_win, gc,
+        gdk_draw_layout (drawable, gc,
                 x_loc-1, y_loc, layout);
-
-    g_object_unref (layout);
 }
 
 static void
 hildon_calendar_paint_main                      (GtkWidget *widget)
+{
+    hildon_calendar_paint_main_region (widget, NULL);
+}
+
+/* Returns the month that hildon_calendar_set_month_prev() (if @direction
+ * is negative) or hildon_calendar_set_month_next() would change to, or
+ * FALSE if they wouldn't change the month */
+static gboolean
+hildon_calendar_get_adjacent_month              (HildonCalendar *calendar,
+                                                 gint direction,
+                                                 gint *year,
+                                                 gint *month)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+
+    if (calendar->display_flags & HILDON_CALENDAR_NO_MONTH_CHANGE)
+        return FALSE;
+
+    *year = calendar->year;
+    *month = calendar->month + (direction < 0 ? -1 : 1);
+
+    if (*month < 0)
+    {
+        if (private_data->min_year && calendar->year <= private_data->min_year)
+            return FALSE;
+        *month = 11;
+        (*year)--;
+    }
+    else if (*month > 11)
+    {
+        if (private_data->max_year && calendar->year >= private_data->max_year)
+            return FALSE;
+        *month = 0;
+        (*year)++;
+    }
+
+    return TRUE;
+}
+
+/* Moves the calendar to @month without any signals or painting, leaving
+ * the selection and focus as hildon_calendar_set_month_next() and
+ * friends would */
+static void
+hildon_calendar_switch_month                    (HildonCalendar *calendar,
+                                                 gint year,
+                                                 gint month)
+{
+    gint month_len;
+    gint row, col;
+
+    calendar->year = year;
+    calendar->month = month;
+    hildon_calendar_compute_days (calendar);
+
+    month_len = month_length[leap (year)][month + 1];
+    if (calendar->selected_day > month_len)
+        calendar->selected_day = month_len;
+
+    for (row = 0; row < 6; row++)
+        for (col = 0; col < 7; col++)
+            if (calendar->day_month[row][col] == MONTH_CURRENT &&
+                    calendar->day[row][col] == calendar->selected_day)
+            {
+                calendar->focus_row = row;
+                calendar->focus_col = col;
+            }
+}
+
+/* Returns the prerendered month matching the current state of the
+ * calendar, if any */
+static HildonCalendarMonthPixmap *
+hildon_calendar_find_prerendered                (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    HildonCalendarMonthPixmap *m;
+    gint i;
+
+    for (i = 0; i < HILDON_CALENDAR_N_PRERENDERED; i++)
+    {
+        m = &private_data->prerendered[i];
+
+        if (m->pixmap &&
+                m->year == calendar->year &&
+                m->month == calendar->month &&
+                m->selected_day == calendar->selected_day &&
+                m->focus_row == calendar->focus_row &&
+                m->focus_col == calendar->focus_col &&
+                m->has_focus == GTK_WIDGET_HAS_FOCUS (calendar) &&
+                m->current_year == private_data->current_year &&
+                m->current_month == private_data->current_month &&
+                m->current_day == private_data->current_day)
+            return m;
+    }
+
+    return NULL;
+}
+
+/* Renders the days of the current month in @m */
+static void
+hildon_calendar_render_month                    (HildonCalendar *calendar,
+                                                 HildonCalendarMonthPixmap *m)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    GtkWidget *widget = GTK_WIDGET (calendar);
+    gint width, height;
+    gint row, col;
+
+    gdk_drawable_get_size (private_data->main_win, &width, &height);
+
+    if (m->pixmap == NULL)
+        m->pixmap = gdk_pixmap_new (private_data->main_win, width, height, -1);
+
+    gdk_gc_set_foreground (calendar->gc, BACKGROUND_COLOR (widget));
+    gdk_draw_rectangle (m->pixmap, calendar->gc, TRUE, 0, 0, width, height);
+
+    for (row = 0; row < 6; row++)
+        for (col = 0; col < 7; col++)
+            hildon_calendar_paint_day_on (widget, m->pixmap, row, col);
+
+    m->year = calendar->year;
+    m->month = calendar->month;
+    m->selected_day = calendar->selected_day;
+    m->focus_row = calendar->focus_row;
+    m->focus_col = calendar->focus_col;
+    m->has_focus = GTK_WIDGET_HAS_FOCUS (calendar);
+    m->current_year = private_data->current_year;
+    m->current_month = private_data->current_month;
+    m->current_day = private_data->current_day;
+}
+
+/* Keeps the current date up to date, so the day marked as today moves
+ * at midnight instead of being painted from an outdated pixmap */
+static void
+hildon_calendar_update_current_date             (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    struct tm *tm;
+    time_t secs;
+
+    secs = time (NULL);
+    tm = localtime (&secs);
+
+    if (tm->tm_mday == private_data->current_day &&
+            tm->tm_mon == private_data->current_month &&
+            tm->tm_year + 1900 == private_data->current_year)
+        return;
+
+    private_data->current_day = tm->tm_mday;
+    private_data->current_month = tm->tm_mon;
+    private_data->current_year = tm->tm_year + 1900;
+
+    hildon_calendar_invalidate_prerendered (calendar);
+}
+
+/* Renders one of the months around the current one that is missing
+ * from the cache, one per iteration so as not to block the main loop
+ * for long */
+static gboolean
+hildon_calendar_prerender_idle                  (gpointer data)
+{
+    HildonCalendar *calendar = HILDON_CALENDAR (data);
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    HildonCalendarMonthPixmap *m;
+    gboolean keep[HILDON_CALENDAR_N_PRERENDERED] = { FALSE };
+    gint year, month, selected_day, focus_row, focus_col, num_marked_dates;
+    gint day[6][7], day_month[6][7], marked_date[31];
+    gint adjacent_year[2], adjacent_month[2];
+    gboolean has_adjacent[2];
+    gint i, j;
+
+    if (private_data->main_win == NULL)
+    {
+        private_data->prerender_id = 0;
+        return FALSE;
+    }
+
+    m = hildon_calendar_find_prerendered (calendar);
+    if (m)
+        keep[m - private_data->prerendered] = TRUE;
+
+    for (i = 0; i < 2; i++)
+        has_adjacent[i] = hildon_calendar_get_adjacent_month (calendar, i ? 1 : -1,
+                &adjacent_year[i], &adjacent_month[i]);
+
+    /* Only the fields changed by hildon_calendar_switch_month() */
+    year = calendar->year;
+    month = calendar->month;
+    selected_day = calendar->selected_day;
+    focus_row = calendar->focus_row;
+    focus_col = calendar->focus_col;
+    num_marked_dates = calendar->num_marked_dates;
+    memcpy (day, calendar->day, sizeof (day));
+    memcpy (day_month, calendar->day_month, sizeof (day_month));
+    memcpy (marked_date, calendar->marked_date, sizeof (marked_date));
+
+    for (i = 0; i < 2; i++)
+    {
+        if (!has_adjacent[i])
+            continue;
+
+        hildon_calendar_switch_month (calendar, adjacent_year[i], adjacent_month[i]);
+        m = hildon_calendar_find_prerendered (calendar);
+
+        if (m == NULL)
+        {
+            for (j = 0; keep[j]; j++);
+
+            hildon_calendar_render_month (calendar, &private_data->prerendered[j]);
+            break;
+        }
+
+        keep[m - private_data->prerendered] = TRUE;
+    }
+
+    calendar->year = year;
+    calendar->month = month;
+    calendar->selected_day = selected_day;
+    calendar->focus_row = focus_row;
+    calendar->focus_col = focus_col;
+    calendar->num_marked_dates = num_marked_dates;
+    memcpy (calendar->day, day, sizeof (day));
+    memcpy (calendar->day_month, day_month, sizeof (day_month));
+    memcpy (calendar->marked_date, marked_date, sizeof (marked_date));
+
+    if (i == 2)
+    {
+        private_data->prerender_id = 0;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+hildon_calendar_queue_prerender                 (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+
+    if (private_data->prerender_months &&
+            private_data->main_win &&
+            private_data->prerender_id == 0)
+        private_data->prerender_id = gdk_threads_add_idle_full (G_PRIORITY_LOW,
+                hildon_calendar_prerender_idle, calendar, NULL);
+}
+
+/* Drops the prerendered months, after something that changes how the
+ * days look */
+static void
+hildon_calendar_invalidate_prerendered          (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    gint i;
+
+    hildon_calendar_stop_slide (calendar);
+
+    for (i = 0; i < HILDON_CALENDAR_N_PRERENDERED; i++)
+    {
+        if (private_data->prerendered[i].pixmap)
+        {
+            g_object_unref (private_data->prerendered[i].pixmap);
+            private_data->prerendered[i].pixmap = NULL;
+        }
+    }
+
+    if (private_data->prerender_id)
+    {
+        g_source_remove (private_data->prerender_id);
+        private_data->prerender_id = 0;
+    }
+
+    hildon_calendar_queue_prerender (calendar);
+}
+
+/* Keeps the days being shown, to slide away from them once the month
+ * changes in @direction */
+static void
+hildon_calendar_begin_slide                     (HildonCalendar *calendar,
+                                                 gint direction)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    HildonCalendarMonthPixmap *m;
+    gint year, month;
+    gint width, height;
+    gboolean sliding;
+
+    sliding = private_data->slide_id != 0;
+    hildon_calendar_stop_slide (calendar);
+
+    /* Don't slide again before the last slide is over, as when going
+     * through the months with auto-repeat */
+    if (sliding ||
+            !private_data->prerender_months ||
+            !private_data->slide_months ||
+            !GTK_WIDGET_DRAWABLE (calendar) ||
+            private_data->freeze_count ||
+            !hildon_calendar_get_adjacent_month (calendar, direction, &year, &month))
+        return;
+
+    m = hildon_calendar_find_prerendered (calendar);
+
+    if (m)
+        private_data->slide_from = g_object_ref (m->pixmap);
+    else
+    {
+        gdk_drawable_get_size (private_data->main_win, &width, &height);
+        private_data->slide_from = gdk_pixmap_new (private_data->main_win,
+                width, height, -1);
+        gdk_draw_drawable (private_data->slide_from, calendar->gc,
+                private_data->main_win, 0, 0, 0, 0, width, height);
+    }
+
+    private_data->slide_direction = direction;
+}
+
+static void
+hildon_calendar_stop_slide                      (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+
+    if (private_data->slide_id)
+    {
+        g_source_remove (private_data->slide_id);
+        private_data->slide_id = 0;
+    }
+
+    if (private_data->slide_from)
+    {
+        g_object_unref (private_data->slide_from);
+        private_data->slide_from = NULL;
+    }
+
+    if (private_data->slide_to)
+    {
+        g_object_unref (private_data->slide_to);
+        private_data->slide_to = NULL;
+    }
+}
+
+/* Paints the current frame of the slide, returns FALSE once it's over */
+static gboolean
+hildon_calendar_paint_slide                     (HildonCalendar *calendar)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    GTimeVal now;
+    gdouble t;
+    gint width, height, offset;
+
+    g_get_current_time (&now);
+    t = ((now.tv_sec - private_data->slide_start.tv_sec) * 1000.0 +
+            (now.tv_usec - private_data->slide_start.tv_usec) / 1000.0) /
+        CALENDAR_SLIDE_DURATION;
+    t = CLAMP (t, 0.0, 1.0);
+
+    /* Decelerate towards the end */
+    t = 1.0 - (1.0 - t) * (1.0 - t);
+
+    gdk_drawable_get_size (private_data->slide_to, &width, &height);
+    offset = width * t;
+
+    gdk_draw_drawable (private_data->main_win, calendar->gc,
+            private_data->slide_from, 0, 0,
+            -private_data->slide_direction * offset, 0, width, height);
+    gdk_draw_drawable (private_data->main_win, calendar->gc,
+            private_data->slide_to, 0, 0,
+            private_data->slide_direction * (width - offset), 0, width, height);
+
+    return t < 1.0;
+}
+
+static gboolean
+hildon_calendar_slide_timeout                   (gpointer data)
+{
+    HildonCalendar *calendar = HILDON_CALENDAR (data);
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+
+    if (hildon_calendar_paint_slide (calendar))
+        return TRUE;
+
+    /* The source is removed by returning FALSE */
+    private_data->slide_id = 0;
+    hildon_calendar_stop_slide (calendar);
+
+    /* The days may have changed during the slide */
+    hildon_calendar_paint_main (GTK_WIDGET (calendar));
+
+    return FALSE;
+}
+
+/* Paints @region (or all of the days if it's NULL) from the prerendered
+ * month matching the calendar, returns FALSE if there is none */
+static gboolean
+hildon_calendar_paint_prerendered               (HildonCalendar *calendar,
+                                                 GdkRegion *region)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    HildonCalendarMonthPixmap *m;
+    GdkRectangle *rects;
+    gint n_rects, i;
+    gint width, height;
+
+    m = hildon_calendar_find_prerendered (calendar);
+
+    if (m == NULL)
+    {
+        hildon_calendar_stop_slide (calendar);
+        return FALSE;
+    }
+
+    if (private_data->slide_from && private_data->slide_to == NULL)
+    {
+        private_data->slide_to = g_object_ref (m->pixmap);
+        g_get_current_time (&private_data->slide_start);
+        private_data->slide_id = gdk_threads_add_timeout (CALENDAR_SLIDE_FRAME_INTERVAL,
+                hildon_calendar_slide_timeout, calendar);
+    }
+
+    if (private_data->slide_to)
+    {
+        hildon_calendar_paint_slide (calendar);
+        return TRUE;
+    }
+
+    if (region == NULL)
+    {
+        gdk_drawable_get_size (m->pixmap, &width, &height);
+        gdk_draw_drawable (private_data->main_win, calendar->gc, m->pixmap,
+                0, 0, 0, 0, width, height);
+        return TRUE;
+    }
+
+    gdk_region_get_rectangles (region, &rects, &n_rects);
+
+    for (i = 0; i < n_rects; i++)
+        gdk_draw_drawable (private_data->main_win, calendar->gc, m->pixmap,
+                rects[i].x, rects[i].y, rects[i].x, rects[i].y,
+                rects[i].width, rects[i].height);
+
+    g_free (rects);
+
+    return TRUE;
+}
+
+/* Paints the days intersecting @region, or all of them if it's NULL. The
+ * area of an expose region has already been cleared by GDK. */
+static void
+hildon_calendar_paint_main_region               (GtkWidget *widget,
+                                                 GdkRegion *region)
 {
     HildonCalendarPrivate *private_data;
+    HildonCalendar *calendar;
     gint row, col;
 
     g_return_if_fail (HILDON_IS_CALENDAR (widget));
     g_return_if_fail (widget->window != NULL);
 
+    calendar = HILDON_CALENDAR (widget);
     private_data = HILDON_CALENDAR_GET_PRIVATE (widget);
 
     if (private_data->freeze_count)
@@ -2580,12 +3161,82 @@ hildon_calendar_paint_main                      (GtkWidget *widget)
         private_data->dirty_main = 1;
         return;
     }
-    private_data->dirty_main = 0;
-    gdk_window_clear (private_data->main_win);
 
-    for (col = 0; col < 7; col++)
-        for (row = 0; row < 6; row++)
-            hildon_calendar_paint_day (widget, row, col);
+    hildon_calendar_update_current_date (calendar);
+
+    if (region == NULL)
+    {
+        private_data->dirty_main = 0;
+        hildon_calendar_queue_prerender (calendar);
+
+        if (hildon_calendar_paint_prerendered (calendar, NULL))
+            return;
+
+        gdk_window_clear (private_data->main_win);
+    }
+    else if (hildon_calendar_paint_prerendered (calendar, region))
+        return;
+
+    for (row = 0; row < 6; row++)
+    {
+        GdkRectangle cell;
+
+        cell.y = top_y_for_row (calendar, row);
+        cell.height = HILDON_DAY_HEIGHT;
+
+        for (col = 0; col < 7; col++)
+        {
+            cell.x = left_x_for_column (calendar, col);
+            cell.width = HILDON_DAY_WIDTH;
+
+            if (region == NULL ||
+                gdk_region_rect_in (region, &cell) != GDK_OVERLAP_RECTANGLE_OUT)
+                hildon_calendar_paint_day (widget, row, col);
+        }
+    }
+}
+
+/* Returns the marks of @month in @year, as a bitset. If @create is
+ * TRUE, the storage for the marks is created if it didn't exist. */
+static guint32 *
+hildon_calendar_lookup_marks                    (HildonCalendar *calendar,
+                                                 guint year,
+                                                 guint month,
+                                                 gboolean create)
+{
+    HildonCalendarPrivate *private_data = HILDON_CALENDAR_GET_PRIVATE (calendar);
+    guint32 *months;
+
+    months = g_hash_table_lookup (private_data->marks, GUINT_TO_POINTER (year));
+
+    if (months == NULL && create)
+    {
+        months = g_new0 (guint32, 12);
+        g_hash_table_insert (private_data->marks, GUINT_TO_POINTER (year), months);
+    }
+
+    return months ? &months[month] : NULL;
+}
+
+/* Fills marked_date with the marks of the month being shown */
+static void
+hildon_calendar_load_marks                      (HildonCalendar *calendar)
+{
+    guint32 *marks;
+    guint32 days;
+    gint day;
+
+    marks = hildon_calendar_lookup_marks (calendar, calendar->year,
+                                          calendar->month, FALSE);
+    days = marks ? *marks : 0;
+
+    calendar->num_marked_dates = 0;
+    for (day = 0; day < 31; day++)
+    {
+        calendar->marked_date[day] = (days & (1 << day)) != 0;
+        if (calendar->marked_date[day])
+            calendar->num_marked_dates++;
+    }
 }
 
 static void
@@ -2658,6 +3309,8 @@ hildon_calendar_compute_days                    (HildonCalendar *calendar)
         }
         col = 0;
     }
+
+    hildon_calendar_load_marks (calendar);
 }
 
 /**
@@ -2935,8 +3588,15 @@ hildon_calendar_clear_marks                     (HildonCalendar *calendar)
 {
     guint day;
 
+    guint32 *marks;
+
     g_return_if_fail (HILDON_IS_CALENDAR (calendar));
 
+    marks = hildon_calendar_lookup_marks (calendar, calendar->year,
+                                          calendar->month, FALSE);
+    if (marks)
+        *marks = 0;
+
     for (day = 0; day < 31; day++)
     {
         calendar->marked_date[day] = FALSE;
@@ -2944,12 +3604,83 @@ hildon_calendar_clear_marks                     (HildonCalendar *calendar)
 
     calendar->num_marked_dates = 0;
 
+    hildon_calendar_invalidate_prerendered (calendar);
+
     if (GTK_WIDGET_DRAWABLE (calendar))
     {
         hildon_calendar_paint_main (GTK_WIDGET (calendar));
     }
 }
 
+/**
+ * hildon_calendar_set_marks:
+ * @calendar: a #HildonCalendar
+ * @year: the year
+ * @month: the month, from 0 to 11
+ * @days: the days to mark, bit n being day n + 1
+ *
+ * Sets the marked days of a month, replacing any previous marks in it.
+ * Marks are kept for every month, so they don't need to be set again
+ * when the month shown by the calendar changes. If @month is being
+ * shown, the calendar is repainted once.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_calendar_set_marks                       (HildonCalendar *calendar,
+                                                 guint year,
+                                                 guint month,
+                                                 guint32 days)
+{
+    guint32 *marks;
+
+    g_return_if_fail (HILDON_IS_CALENDAR (calendar));
+    g_return_if_fail (month <= 11);
+
+    marks = hildon_calendar_lookup_marks (calendar, year, month, days != 0);
+    if (marks == NULL || *marks == days)
+        return;
+
+    *marks = days;
+
+    hildon_calendar_invalidate_prerendered (calendar);
+
+    if (year == (guint) calendar->year && month == (guint) calendar->month)
+    {
+        hildon_calendar_load_marks (calendar);
+
+        if (GTK_WIDGET_DRAWABLE (calendar))
+            hildon_calendar_paint_main (GTK_WIDGET (calendar));
+    }
+}
+
+/**
+ * hildon_calendar_get_marks:
+ * @calendar: a #HildonCalendar
+ * @year: the year
+ * @month: the month, from 0 to 11
+ *
+ * Gets the marked days of a month. See hildon_calendar_set_marks().
+ *
+ * Return value: the marked days, bit n being day n + 1.
+ *
+ * Since: 2.2
+ **/
+guint32
+hildon_calendar_get_marks                       (HildonCalendar *calendar,
+                                                 guint year,
+                                                 guint month)
+{
+    guint32 *marks;
+
+    g_return_val_if_fail (HILDON_IS_CALENDAR (calendar), 0);
+    g_return_val_if_fail (month <= 11, 0);
+
+    marks = hildon_calendar_lookup_marks (calendar, year, month, FALSE);
+
+    return marks ? *marks : 0;
+}
+
 gboolean
 hildon_calendar_mark_day                        (HildonCalendar *calendar,
                                                  guint day)
@@ -2957,11 +3688,16 @@ hildon_calendar_mark_day                        (HildonCalendar *calendar,
     g_return_val_if_fail (HILDON_IS_CALENDAR (calendar), FALSE);
     if (day >= 1 && day <= 31 && calendar->marked_date[day-1] == FALSE)
     {
+        *hildon_calendar_lookup_marks (calendar, calendar->year,
+                                       calendar->month, TRUE) |= 1 << (day - 1);
+
         calendar->marked_date[day - 1] = TRUE;
         calendar->num_marked_dates++;
 
+        hildon_calendar_invalidate_prerendered (calendar);
+
         if (GTK_WIDGET_DRAWABLE (GTK_WIDGET (calendar)))
-            hildon_calendar_paint_day_num (GTK_WIDGET (calendar), day-1);
+            hildon_calendar_paint_day_num (GTK_WIDGET (calendar), day);
     }
 
     return TRUE;
@@ -2975,11 +3711,16 @@ hildon_calendar_unmark_day                      (HildonCalendar *calendar,
 
     if (day >= 1 && day <= 31 && calendar->marked_date[day-1] == TRUE)
     {
+        *hildon_calendar_lookup_marks (calendar, calendar->year,
+                                       calendar->month, TRUE) &= ~(1 << (day - 1));
+
         calendar->marked_date[day - 1] = FALSE;
         calendar->num_marked_dates--;
 
+        hildon_calendar_invalidate_prerendered (calendar);
+
         if (GTK_WIDGET_DRAWABLE (GTK_WIDGET (calendar)))
-            hildon_calendar_paint_day_num (GTK_WIDGET (calendar), day-1);
+            hildon_calendar_paint_day_num (GTK_WIDGET (calendar), day);
     }
 
     return TRUE;
@@ -3269,11 +4010,17 @@ hildon_calendar_motion_notify                   (GtkWidget *widget,
             else if ((private_data->prev_row != c_row || private_data->prev_col != c_col) &&
                     (calendar->highlight_row != -1 && calendar->highlight_col != -1))
             {
+                gint focus_row = calendar->focus_row;
+                gint focus_col = calendar->focus_col;
+
                 hildon_calendar_select_and_focus_day (calendar, 
                         calendar->day[c_row][c_col]);
-                /* Update passive focus indicators work weekday number and name */
-                hildon_calendar_paint_week_numbers (GTK_WIDGET (calendar));
-                hildon_calendar_paint_day_names (GTK_WIDGET (calendar));
+                /* Update passive focus indicators work weekday number and name,
+                 * only when they move */
+                if (calendar->focus_row != focus_row)
+                    hildon_calendar_paint_week_numbers (GTK_WIDGET (calendar));
+                if (calendar->focus_col != focus_col)
+                    hildon_calendar_paint_day_names (GTK_WIDGET (calendar));
             }
             private_data->prev_col = c_col;
             private_data->prev_row = c_row;    
@@ -3430,7 +4177,10 @@ hildon_calendar_paint_arrow                     (GtkWidget *widget,
 
     if (private_data->freeze_count)
     {
-        private_data->dirty_header = 1;
+        if (arrow == ARROW_MONTH_LEFT || arrow == ARROW_MONTH_RIGHT)
+            private_data->dirty_footer = 1;
+        else
+            private_data->dirty_header = 1;
         return;
     }
     window = private_data->arrow_win[arrow];
@@ -3543,6 +4293,10 @@ hildon_calendar_thaw                            (HildonCalendar *calendar)
                 if (GTK_WIDGET_DRAWABLE (calendar))
                     hildon_calendar_paint_header (GTK_WIDGET (calendar));
 
+            if (private_data->dirty_footer)
+                if (GTK_WIDGET_DRAWABLE (calendar))
+                    hildon_calendar_paint_footer (GTK_WIDGET (calendar));
+
             if (private_data->dirty_day_names)
                 if (GTK_WIDGET_DRAWABLE (calendar))
                     hildon_calendar_paint_day_names (GTK_WIDGET (calendar));
@@ -3595,6 +4349,10 @@ static void
 hildon_calendar_style_set                       (GtkWidget *widget,
                                                  GtkStyle *previous_style)
 {
+    /* The font may have changed */
+    hildon_calendar_clear_number_layouts (HILDON_CALENDAR (widget));
+    hildon_calendar_invalidate_prerendered (HILDON_CALENDAR (widget));
+
     if (previous_style && GTK_WIDGET_REALIZED (widget))
         hildon_calendar_set_background(widget);
 }
@@ -3620,6 +4378,7 @@ hildon_calendar_state_changed                   (GtkWidget *widget,
         else 
             private_data->arrow_state[i] = GTK_STATE_INSENSITIVE;
 
+    hildon_calendar_invalidate_prerendered (HILDON_CALENDAR (widget));
     hildon_calendar_set_background (widget);
 }
 
@@ -3635,6 +4394,8 @@ hildon_calendar_finalize                        (GObject *object)
         g_free (private_data->abbreviated_dayname[i]);
     for (i = 0; i < 12; i++)
         g_free (private_data->monthname[i]);
+    hildon_calendar_clear_number_layouts (HILDON_CALENDAR (object));
+    g_hash_table_destroy (private_data->marks);
     g_free (private_data);
 
     (* G_OBJECT_CLASS (parent_class)->finalize) (object);
@@ -4006,6 +4767,7 @@ hildon_calendar_set_property                    (GObject *object,
             break;
         case PROP_WEEK_START:
             private_data->week_start = g_value_get_int (value);
+            hildon_calendar_invalidate_prerendered (calendar);
             break;
         case PROP_MIN_YEAR:
             val = g_value_get_int (value);
@@ -4035,6 +4797,15 @@ hildon_calendar_set_property                    (GObject *object,
             else
                 g_warning("max-year cannot be less than min-year");
             break;
+        case PROP_PRERENDER_MONTHS:
+            private_data->prerender_months = g_value_get_boolean (value);
+            hildon_calendar_invalidate_prerendered (calendar);
+            break;
+        case PROP_SLIDE_MONTHS:
+            private_data->slide_months = g_value_get_boolean (value);
+            if (!private_data->slide_months)
+                hildon_calendar_stop_slide (calendar);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -4089,6 +4860,12 @@ hildon_calendar_get_property                    (GObject *object,
         case PROP_MAX_YEAR:
             g_value_set_int (value, private_data->max_year);
             break;
+        case PROP_PRERENDER_MONTHS:
+            g_value_set_boolean (value, private_data->prerender_months);
+            break;
+        case PROP_SLIDE_MONTHS:
+            g_value_set_boolean (value, private_data->slide_months);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -4279,6 +5056,7 @@ hildon_calendar_drag_data_received              (GtkWidget *widget,
  */
 static void
 hildon_calendar_check_current_date              (HildonCalendar *calendar, 
+                                                 GdkDrawable *drawable,
                                                  gint x, 
                                                  gint y)
 {
@@ -4290,7 +5068,7 @@ hildon_calendar_check_current_date              (HildonCalendar *calendar,
             calendar->year == private_data->current_year)
     {
         gtk_paint_box( GTK_WIDGET (calendar)->style,
-                private_data->main_win,
+                drawable,
                 GTK_STATE_NORMAL,
                 GTK_SHADOW_NONE, NULL,
                 GTK_WIDGET (calendar), "current-day",
@@ -154,6 +154,17 @@ hildon_calendar_unmark_day                      (HildonCalendar *calendar,
 void    
 hildon_calendar_clear_marks                     (HildonCalendar *calendar);
 
+void
+hildon_calendar_set_marks                       (HildonCalendar *calendar,
+                                                 guint year,
+                                                 guint month,
+                                                 guint32 days);
+
+guint32
+hildon_calendar_get_marks                       (HildonCalendar *calendar,
+                                                 guint year,
+                                                 guint month);
+
 void       
 hildon_calendar_set_display_options             (HildonCalendar *calendar,
                                                  HildonCalendarDisplayOptions flags);
@@ -51,13 +51,26 @@ struct                                          _HildonColorChooserPrivate
     GdkPixbuf *dimmed_plane;
     GdkPixbuf *dimmed_bar;
 
-    struct {
-        unsigned short last_expose_hue;
+    /* Buffer the hue bar and the SV plane are rendered in, kept from
+     * one expose to the next */
+    guint32 *render_buf;
+    gint render_buf_size;
 
-        GTimeVal last_expose_time;
+    /* The hue bar for the current size, and the SV plane for the current
+     * size and hue. The hue marker and the crosshair are drawn on top */
+    GdkPixmap *hue_bar;
+    GdkPixmap *sv_plane;
+    unsigned short sv_plane_hue;
 
-        int expose_queued;
-    } expose_info;
+    /* Changes are rendered at most once per frame, from update_id. The
+     * drawn_* fields keep what the last update left on the screen */
+    guint update_id;
+    GTimeVal last_update_time;
+    gboolean color_changed;
+
+    unsigned short drawn_hue;
+    GdkRectangle drawn_crosshair;
+    GdkRectangle drawn_hue_marker;
 };
 
 #endif                                          /* __HILDON_COLOR_CHOOSER_H__ */
@@ -39,6 +39,8 @@
 
 #undef                                          HILDON_DISABLE_DEPRECATED
 
+#include                                        <string.h>
+
 #include                                        "hildon-color-chooser.h"
 #include                                        "hildon-color-chooser-private.h"
 
@@ -113,13 +115,9 @@ inline void
 inline_clip_to_alloc                            (void *s, 
                                                  GtkAllocation *a);
 
-inline void 
-inline_sub_times                                (GTimeVal *result, 
-                                                 GTimeVal *greater, 
-                                                 GTimeVal *lesser);
-
-inline void 
-inline_limited_expose                           (HildonColorChooser *self);
+static void
+hildon_color_chooser_queue_update               (HildonColorChooser *self,
+                                                 gboolean color_changed);
 
 inline void 
 inline_draw_hue_bar                             (GtkWidget *widget, 
@@ -154,18 +152,40 @@ inline_draw_sv_plane_dimmed                     (HildonColorChooser *self,
                                                  int h);
 
 inline void 
-inline_draw_crosshair                           (unsigned char *buf, 
+inline_draw_crosshair                           (HildonColorChooser *self, 
                                                  int x, 
                                                  int y, 
                                                  int w, 
                                                  int h);
 
+static void
+drop_cached_planes                              (HildonColorChooserPrivate *priv);
+
 inline void 
 inline_h2rgb                                    (unsigned short hue, 
                                                  unsigned long *rgb);
 
 static gboolean
-hildon_color_chooser_expose_timer               (gpointer data);
+hildon_color_chooser_update                     (gpointer data);
+
+static void
+get_crosshair_rect                              (HildonColorChooserPrivate *priv, 
+                                                 GdkRectangle *rect);
+
+static void
+get_hue_marker_rect                             (HildonColorChooserPrivate *priv, 
+                                                 GdkRectangle *rect);
+
+static void
+reset_drawn_markers                             (HildonColorChooserPrivate *priv);
+
+static void
+record_drawn_marker                             (GdkRectangle *drawn, 
+                                                 GdkRectangle *rect, 
+                                                 int x, 
+                                                 int y, 
+                                                 int w, 
+                                                 int h);
 
 static void
 hildon_color_chooser_set_property               (GObject *object, 
@@ -179,12 +199,30 @@ hildon_color_chooser_get_property               (GObject *object,
                                                  GValue *value, 
                                                  GParamSpec *pspec);
 
-#define                                         EXPOSE_INTERVAL 50000
+#define                                         FRAME_INTERVAL 16
 
 #define                                         FULL_COLOR8 0xff
 
 #define                                         FULL_COLOR 0x00ffffff
 
+/* Pixels in the render buffer, in the byte order expected by
+ * gdk_draw_rgb_32_image() */
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define                                         PACK_RGB(r, g, b) \
+                                                ((r) | ((g) << 8) | ((b) << 16))
+#else
+#define                                         PACK_RGB(r, g, b) \
+                                                (((r) << 24) | ((g) << 16) | ((b) << 8))
+#endif
+
+/* The SV plane is rendered four pixels at a time where the compiler can
+ * map its generic vectors to SIMD instructions (SSE2, NEON) */
+#if defined (__GNUC__) && (defined (__SSE2__) || defined (__ARM_NEON__))
+#define                                         USE_VECTORS 1
+
+typedef guint32                                 v4u32 __attribute__ ((vector_size (16)));
+#endif
+
 enum 
 {
     COLOR_CHANGED,
@@ -242,13 +280,25 @@ hildon_color_chooser_init                       (HildonColorChooser *sel)
     priv->mousestate = 0;
     priv->mousein = FALSE;
 
-    g_get_current_time (&priv->expose_info.last_expose_time);
+    priv->update_id = 0;
+    priv->last_update_time.tv_sec = 0;
+    priv->last_update_time.tv_usec = 0;
+    priv->color_changed = FALSE;
 
-    priv->expose_info.last_expose_hue = priv->currhue;
-    priv->expose_info.expose_queued = 0;
+    priv->drawn_hue = priv->currhue;
+    priv->drawn_crosshair.x = priv->drawn_crosshair.y = 0;
+    priv->drawn_crosshair.width = priv->drawn_crosshair.height = 0;
+    priv->drawn_hue_marker.x = priv->drawn_hue_marker.y = 0;
+    priv->drawn_hue_marker.width = priv->drawn_hue_marker.height = 0;
 
     priv->dimmed_plane = NULL;
     priv->dimmed_bar = NULL;
+
+    priv->render_buf = NULL;
+    priv->render_buf_size = 0;
+
+    priv->hue_bar = NULL;
+    priv->sv_plane = NULL;
 }
 
 static void
@@ -336,6 +386,17 @@ hildon_color_chooser_dispose                    (HildonColorChooser *sel)
         priv->dimmed_plane = NULL;
     }
 
+    g_free (priv->render_buf);
+    priv->render_buf = NULL;
+    priv->render_buf_size = 0;
+
+    drop_cached_planes (priv);
+
+    if (priv->update_id) {
+        g_source_remove (priv->update_id);
+        priv->update_id = 0;
+    }
+
     G_OBJECT_CLASS (parent_class)->dispose (G_OBJECT (sel));
 }
 
@@ -374,6 +435,29 @@ hildon_color_chooser_size_allocate              (GtkWidget *widget,
     priv->spa.height = alloc->height - outer.top - outer.bottom;
     priv->spa.width = alloc->width - outer.left - outer.right - inner.top - inner.bottom;
 
+    if (priv->hue_bar != NULL) {
+        gint w, h;
+
+        gdk_drawable_get_size (priv->hue_bar, &w, &h);
+
+        if (w != priv->hba.width || h != priv->hba.height) {
+            drop_cached_planes (priv);
+        }
+    }
+
+    if (priv->sv_plane != NULL) {
+        gint w, h;
+
+        gdk_drawable_get_size (priv->sv_plane, &w, &h);
+
+        if (w != priv->spa.width || h != priv->spa.height) {
+            drop_cached_planes (priv);
+        }
+    }
+
+    /* The whole widget is repainted with the new layout */
+    reset_drawn_markers (priv);
+
     if (GTK_WIDGET_REALIZED (widget)) {
         gdk_window_move_resize (priv->event_window, 
                 widget->allocation.x, 
@@ -432,6 +516,8 @@ hildon_color_chooser_unrealize                  (GtkWidget *widget)
 	priv->event_window = NULL;
     }
 
+    drop_cached_planes (priv);
+
     GTK_WIDGET_CLASS(parent_class)->unrealize(widget);
 }
 
@@ -443,6 +529,8 @@ hildon_color_chooser_map                        (GtkWidget *widget)
     g_assert (priv);
     GTK_WIDGET_CLASS(parent_class)->map(widget);
 
+    reset_drawn_markers (priv);
+
     if (priv->event_window) {
         gdk_window_show (priv->event_window);
     }
@@ -526,107 +614,107 @@ hildon_color_chooser_expose                     (GtkWidget *widget,
                 priv->spa.height + 3);
     }
 
-    if (priv->expose_info.expose_queued) {
-        if (GTK_WIDGET_SENSITIVE (widget)) {
-            inline_draw_hue_bar (widget, priv->hba.x, priv->hba.y, priv->hba.width, priv->hba.height, priv->hba.y, priv->hba.height);
-
-            inline_draw_sv_plane (sel, priv->spa.x, priv->spa.y, priv->spa.width, priv->spa.height);
-        } else {
-            inline_draw_hue_bar_dimmed (widget, priv->hba.x, priv->hba.y, priv->hba.width, priv->hba.height, priv->hba.y, priv->hba.height);
-
-            inline_draw_sv_plane_dimmed (sel, priv->spa.x, priv->spa.y, priv->spa.width, priv->spa.height);
-        }
-
-        priv->expose_info.expose_queued = 0;
+    /* clip hue bar region */
+    area.x = event->area.x;
+    area.y = event->area.y;
+    area.w = event->area.width;
+    area.h = event->area.height;
 
-        g_get_current_time (&priv->expose_info.last_expose_time);
+    inline_clip_to_alloc (&area, &priv->hba);
 
+    if(GTK_WIDGET_SENSITIVE (widget)) {
+        inline_draw_hue_bar (widget, area.x, area.y, area.w, area.h, priv->hba.y, priv->hba.height);
     } else {
-        /* clip hue bar region */
-        area.x = event->area.x;
-        area.y = event->area.y;
-        area.w = event->area.width;
-        area.h = event->area.height;
-
-        inline_clip_to_alloc (&area, &priv->hba);
-
-        if(GTK_WIDGET_SENSITIVE (widget)) {
-            inline_draw_hue_bar (widget, area.x, area.y, area.w, area.h, priv->hba.y, priv->hba.height);
-        } else {
-            inline_draw_hue_bar_dimmed (widget, area.x, area.y, area.w, area.h, priv->hba.y, priv->hba.height);
-        }
-        
-        area.x = event->area.x;
-        area.y = event->area.y;
-        area.w = event->area.width;
-        area.h = event->area.height;
+        inline_draw_hue_bar_dimmed (widget, area.x, area.y, area.w, area.h, priv->hba.y, priv->hba.height);
+    }
+    
+    area.x = event->area.x;
+    area.y = event->area.y;
+    area.w = event->area.width;
+    area.h = event->area.height;
 
-        inline_clip_to_alloc (&area, &priv->spa);
+    inline_clip_to_alloc (&area, &priv->spa);
 
-        if (GTK_WIDGET_SENSITIVE (widget)) {
-            inline_draw_sv_plane (sel, area.x, area.y, area.w, area.h);
-        } else {
-            inline_draw_sv_plane_dimmed (sel, area.x, area.y, area.w, area.h);
-        }
+    if (GTK_WIDGET_SENSITIVE (widget)) {
+        inline_draw_sv_plane (sel, area.x, area.y, area.w, area.h);
+    } else {
+        inline_draw_sv_plane_dimmed (sel, area.x, area.y, area.w, area.h);
     }
 
     return FALSE;
 }
 
 
-inline void 
-inline_sub_times                                (GTimeVal *result, 
-                                                 GTimeVal *greater, 
-                                                 GTimeVal *lesser)
+static void
+get_crosshair_rect                              (HildonColorChooserPrivate *priv, 
+                                                 GdkRectangle *rect)
 {
-    result->tv_sec = greater->tv_sec - lesser->tv_sec;
-    result->tv_usec = greater->tv_usec - lesser->tv_usec;
-
-    if (result->tv_usec < 0) {
-        result->tv_sec--;
-        result->tv_usec += 1000000;
-    }
+    rect->x = priv->spa.x + (priv->spa.width * priv->currval / 0xffff) - 4;
+    rect->y = priv->spa.y + (priv->spa.height * priv->currsat / 0xffff) - 4;
+    rect->width = 8;
+    rect->height = 8;
 }
 
-inline void 
-inline_limited_expose                           (HildonColorChooser *sel)
+static void
+get_hue_marker_rect                             (HildonColorChooserPrivate *priv, 
+                                                 GdkRectangle *rect)
 {
-    GTimeVal curr_time, result;
-    GdkEventExpose event;
-    HildonColorChooserPrivate *priv; 
-   
-    if (! GTK_WIDGET_REALIZED (GTK_WIDGET (sel))) {
-        return;
-    }
+    rect->x = priv->hba.x;
+    rect->y = priv->hba.y + (priv->currhue * priv->hba.height / 0xffff) - 1;
+    rect->width = priv->hba.width;
+    rect->height = 3;
+}
 
-    priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (sel);
-    g_assert (priv);
+/* The markers are painted where the current color puts them by the
+ * first expose after a map or a new layout */
+static void
+reset_drawn_markers                             (HildonColorChooserPrivate *priv)
+{
+    get_crosshair_rect (priv, &priv->drawn_crosshair);
+    get_hue_marker_rect (priv, &priv->drawn_hue_marker);
+    priv->drawn_hue = priv->currhue;
+}
 
-    if(priv->currhue == priv->expose_info.last_expose_hue) {
-        return; /* no need to redraw */
+/* Remembers that the marker at @rect was painted within (x, y, w, h).
+ * If only a part of it was, the old one may still be on screen too */
+static void
+record_drawn_marker                             (GdkRectangle *drawn, 
+                                                 GdkRectangle *rect, 
+                                                 int x, 
+                                                 int y, 
+                                                 int w, 
+                                                 int h)
+{
+    if (rect->x >= x && rect->y >= y &&
+        rect->x + rect->width <= x + w && rect->y + rect->height <= y + h) {
+        *drawn = *rect;
+    } else {
+        gdk_rectangle_union (drawn, rect, drawn);
     }
+}
 
-    priv->expose_info.last_expose_hue = priv->currhue;
-
-    g_get_current_time (&curr_time);
-
-    inline_sub_times (&result, &curr_time, &priv->expose_info.last_expose_time);
-
-    if(result.tv_sec != 0 || result.tv_usec >= EXPOSE_INTERVAL) {
+/* Schedules the color to be rendered with the next frame; color-changed
+ * is emitted then too if @color_changed */
+static void
+hildon_color_chooser_queue_update               (HildonColorChooser *sel,
+                                                 gboolean color_changed)
+{
+    HildonColorChooserPrivate *priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (sel);
+    GTimeVal now;
+    glong elapsed;
 
-        priv->expose_info.expose_queued = 1;
+    priv->color_changed |= color_changed;
 
-        event.type = GDK_EXPOSE;
-        event.area.width = 0;
-        event.area.height = 0;
-        event.window = GTK_WIDGET(sel)->window;
+    if (priv->update_id) {
+        return;
+    }
 
-        gtk_widget_send_expose(GTK_WIDGET(sel), (GdkEvent *)&event);
+    g_get_current_time (&now);
+    elapsed = (now.tv_sec - priv->last_update_time.tv_sec) * 1000 +
+        (now.tv_usec - priv->last_update_time.tv_usec) / 1000;
 
-    } else if(! priv->expose_info.expose_queued) {
-        priv->expose_info.expose_queued = 1;
-        gdk_threads_add_timeout ((EXPOSE_INTERVAL - result.tv_usec) / 1000, hildon_color_chooser_expose_timer, sel);
-    }
+    priv->update_id = gdk_threads_add_timeout (CLAMP (FRAME_INTERVAL - elapsed, 0, FRAME_INTERVAL),
+            hildon_color_chooser_update, sel);
 }
 
 static gboolean 
@@ -650,8 +738,7 @@ hildon_color_chooser_button_press               (GtkWidget *widget,
         tmp = x - priv->spa.x;
         priv->currval = tmp * 0xffff / priv->spa.width;
 
-        g_signal_emit (sel, color_chooser_signals[COLOR_CHANGED], 0);
-        gtk_widget_queue_draw (widget);
+        hildon_color_chooser_queue_update (sel, TRUE);
 
         priv->mousestate = 1;
         priv->mousein = TRUE;
@@ -664,8 +751,7 @@ hildon_color_chooser_button_press               (GtkWidget *widget,
         tmp = y - priv->hba.y;
         priv->currhue = tmp * 0xffff / priv->hba.height;
 
-        g_signal_emit (sel, color_chooser_signals[COLOR_CHANGED], 0);
-        inline_limited_expose (sel);
+        hildon_color_chooser_queue_update (sel, TRUE);
 
         priv->mousestate = 2;
         priv->mousein = TRUE;
@@ -715,8 +801,7 @@ hildon_color_chooser_pointer_motion             (GtkWidget *widget,
             priv->currsat = (((long)(y - priv->spa.y)) * 0xffff) / priv->spa.height;
             priv->currval = (((long)(x - priv->spa.x)) * 0xffff) / priv->spa.width;
 
-            g_signal_emit (sel, color_chooser_signals[COLOR_CHANGED], 0);
-            gtk_widget_queue_draw(widget);
+            hildon_color_chooser_queue_update (sel, TRUE);
 
         } else if (priv->mousein == TRUE) {
         }
@@ -731,8 +816,7 @@ hildon_color_chooser_pointer_motion             (GtkWidget *widget,
             if(tmp != priv->currhue) {
                 priv->currhue = tmp;
 
-                g_signal_emit (sel, color_chooser_signals[COLOR_CHANGED], 0);
-                inline_limited_expose (sel);
+                hildon_color_chooser_queue_update (sel, TRUE);
             }
 
         } else if (priv->mousein == TRUE) {
@@ -845,7 +929,7 @@ hildon_color_chooser_set_color                  (HildonColorChooser *chooser,
     priv->currsat = sat;
     priv->currval = val;
 
-    inline_limited_expose (chooser);
+    hildon_color_chooser_queue_update (chooser, FALSE);
     g_signal_emit (chooser, color_chooser_signals[COLOR_CHANGED], 0);
 }
 
@@ -961,8 +1045,135 @@ intern_h2rgb8                                   (unsigned short hue,
     }
 }
 
-/* optimization: do not ask hue for each round but have bilinear vectors */
-/* rethink: benefits from handling data 8 bit? (no shift round) */
+static guint32 *
+get_render_buffer                               (HildonColorChooserPrivate *priv,
+                                                 int size)
+{
+    if (size > priv->render_buf_size) {
+        g_free (priv->render_buf);
+        priv->render_buf = g_new (guint32, size);
+        priv->render_buf_size = size;
+    }
+
+    return priv->render_buf;
+}
+
+/* Renders the rows y to y + h of a hue bar of height sh */
+static void
+render_hue_bar                                  (guint32 *buf, 
+                                                 int w, 
+                                                 int y, 
+                                                 int h, 
+                                                 int sh)
+{
+    unsigned short hvec, hcurr;
+    unsigned char tmp[3];
+    guint32 pixel;
+    int i, j;
+
+    hvec = 65535 / sh;
+    hcurr = hvec * y;
+
+    for (i = 0; i < h; i++) {
+        intern_h2rgb8 (hcurr, tmp);
+        pixel = PACK_RGB (tmp[0], tmp[1], tmp[2]);
+
+        for (j = 0; j < w; j++) {
+            buf[j] = pixel;
+        }
+
+        buf += w;
+        hcurr += hvec;
+    }
+}
+
+/* Renders the area (x, y, w, h) of an SV plane of size sw * sh. Each row
+ * goes from black to a mix of the hue and white, which is a linear ramp
+ * per channel in 8.16 fixed point */
+static void
+render_sv_plane                                 (guint32 *buf, 
+                                                 unsigned short hue, 
+                                                 int sw, 
+                                                 int sh, 
+                                                 int x, 
+                                                 int y, 
+                                                 int w, 
+                                                 int h)
+{
+    unsigned long rgbtmp[3];
+    guint32 rgbx[3] = { FULL_COLOR, FULL_COLOR, FULL_COLOR }, ramp[3];
+    gint32 rgby[3];
+    int i, j, c;
+
+    inline_h2rgb (hue, rgbtmp);
+
+    for (c = 0; c < 3; c++) {
+        rgby[c] = (gint32) (rgbtmp[c] - rgbx[c]) / (sw * sh);
+        rgbx[c] /= sw;
+        rgbx[c] += y * rgby[c];
+    }
+
+    for (i = 0; i < h; i++) {
+        j = 0;
+
+#ifdef USE_VECTORS
+        {
+            v4u32 r, g, b, pixels;
+            v4u32 dr, dg, db;
+
+            r = (v4u32) { x, x + 1, x + 2, x + 3 } * rgbx[0];
+            g = (v4u32) { x, x + 1, x + 2, x + 3 } * rgbx[1];
+            b = (v4u32) { x, x + 1, x + 2, x + 3 } * rgbx[2];
+
+            dr = (v4u32) { 4, 4, 4, 4 } * rgbx[0];
+            dg = (v4u32) { 4, 4, 4, 4 } * rgbx[1];
+            db = (v4u32) { 4, 4, 4, 4 } * rgbx[2];
+
+            for (; j + 4 <= w; j += 4) {
+                pixels = PACK_RGB (r >> 16, g >> 16, b >> 16);
+                memcpy (buf + j, &pixels, sizeof (pixels));
+
+                r += dr;
+                g += dg;
+                b += db;
+            }
+        }
+#endif
+
+        for (c = 0; c < 3; c++) {
+            ramp[c] = rgbx[c] * (x + j);
+        }
+
+        for (; j < w; j++) {
+            buf[j] = PACK_RGB (ramp[0] >> 16, ramp[1] >> 16, ramp[2] >> 16);
+
+            ramp[0] += rgbx[0];
+            ramp[1] += rgbx[1];
+            ramp[2] += rgbx[2];
+        }
+
+        buf += w;
+
+        rgbx[0] += rgby[0];
+        rgbx[1] += rgby[1];
+        rgbx[2] += rgby[2];
+    }
+}
+
+static void
+drop_cached_planes                              (HildonColorChooserPrivate *priv)
+{
+    if (priv->hue_bar != NULL) {
+        g_object_unref (priv->hue_bar);
+        priv->hue_bar = NULL;
+    }
+
+    if (priv->sv_plane != NULL) {
+        g_object_unref (priv->sv_plane);
+        priv->sv_plane = NULL;
+    }
+}
+
 inline void 
 inline_draw_hue_bar                             (GtkWidget *widget, 
                                                  int x, 
@@ -974,43 +1185,45 @@ inline_draw_hue_bar                             (GtkWidget *widget,
 {
     HildonColorChooserPrivate *priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (widget);
 
-    unsigned short hvec, hcurr;
-    unsigned char *buf, *ptr, tmp[3];
-    int i, j, tmpy;
+    guint32 *buf;
+    GdkRectangle rect;
+    int tmpy;
     g_assert (priv);
 
     if (w <= 0 || h <= 0) {
         return;
     }
 
-    buf = (unsigned char *) g_malloc (w * h * 3);
+    /* The bar doesn't depend on the color, render it once per size */
+    if (priv->hue_bar == NULL) {
+        buf = get_render_buffer (priv, priv->hba.width * priv->hba.height);
 
-    hvec = 65535 / sh;
-    hcurr = hvec * (y - sy);
-    
-    ptr = buf;
+        render_hue_bar (buf, priv->hba.width, 0, priv->hba.height, sh);
 
-    for (i = 0; i < h; i++) {
-        intern_h2rgb8 (hcurr, tmp);
-
-        for (j = 0; j < w; j++) {
-            ptr[0] = tmp[0];
-            ptr[1] = tmp[1];
-            ptr[2] = tmp[2];
-            ptr += 3;
-        }
-
-        hcurr += hvec;
+        priv->hue_bar = gdk_pixmap_new (widget->window, priv->hba.width, priv->hba.height, -1);
+        gdk_draw_rgb_32_image (priv->hue_bar, 
+                widget->style->fg_gc[0], 
+                0, 0, 
+                priv->hba.width, priv->hba.height, 
+                GDK_RGB_DITHER_NONE, (guchar *) buf, priv->hba.width * 4);
     }
 
-
-    gdk_draw_rgb_image (widget->parent->window, 
+    gdk_draw_drawable (widget->parent->window, 
             widget->style->fg_gc[0], 
+            priv->hue_bar, 
+            x - priv->hba.x, y - sy, 
             x, y, 
-            w, h, 
-            GDK_RGB_DITHER_NONE, buf, w * 3);
+            w, h);
 
     tmpy = priv->hba.y + (priv->currhue * priv->hba.height / 0xffff);
+
+    if (tmpy + 1 < y || tmpy - 1 >= y + h) {
+        return; /* the marker is not in the area */
+    }
+
+    get_hue_marker_rect (priv, &rect);
+    record_drawn_marker (&priv->drawn_hue_marker, &rect, x, y, w, h);
+
     gdk_draw_line (widget->parent->window, widget->style->fg_gc[GTK_WIDGET_STATE(widget)], priv->hba.x, tmpy, priv->hba.x + priv->hba.width - 1, tmpy);
 
     if ((((priv->currhue * priv->hba.height) & 0xffff) > 0x8000) && (tmpy < (priv->hba.y + priv->hba.height))) {
@@ -1020,8 +1233,6 @@ inline_draw_hue_bar                             (GtkWidget *widget,
         gdk_draw_line(widget->parent->window, widget->style->fg_gc[GTK_WIDGET_STATE(widget)], priv->hba.x, 
                 tmpy-1, priv->hba.x + priv->hba.width - 1, tmpy-1);
     }
-
-    g_free(buf);
 }
 
 inline void 
@@ -1075,35 +1286,52 @@ inline_draw_hue_bar_dimmed                      (GtkWidget *widget,
     gdk_draw_pixbuf (widget->parent->window, widget->style->fg_gc [0], priv->dimmed_bar, 0, 0, x, y, w, h, GDK_RGB_DITHER_NONE, 0, 0);
 }
 
+/* Draws the parts of the crosshair inside (x, y, w, h) over the SV plane */
 inline void 
-inline_draw_crosshair                           (unsigned char *buf, 
+inline_draw_crosshair                           (HildonColorChooser *sel, 
                                                  int x, 
                                                  int y, 
                                                  int w, 
                                                  int h)
 {
+    GtkWidget *widget = GTK_WIDGET (sel);
+    HildonColorChooserPrivate *priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (sel);
+    GdkPoint white[64], black[64];
+    GdkRectangle rect;
+    int n_white = 0, n_black = 0;
     int i, j, sx, sy;
 
-    /* bad "clipping", clip the loop to save cpu */
+    get_crosshair_rect (priv, &rect);
+
     for(i = 0; i < 8; i++) {
         for(j = 0; j < 8; j++) {
-            sx = j + x; sy = i + y;
-
-            if (sx >= 0 && sx < w && sy >= 0 && sy < h) {
-                if (crosshair[j + 8*i]) {
-                    if (crosshair[j + 8*i] & 0x1) {
-                        buf[(sx)*3+(sy)*w*3+0] = 255;
-                        buf[(sx)*3+(sy)*w*3+1] = 255;
-                        buf[(sx)*3+(sy)*w*3+2] = 255;
-                    } else {
-                        buf[(sx)*3+(sy)*w*3+0] = 0;
-                        buf[(sx)*3+(sy)*w*3+1] = 0;
-                        buf[(sx)*3+(sy)*w*3+2] = 0;
-                    }
+            sx = j + rect.x; sy = i + rect.y;
+
+            if (crosshair[j + 8*i] && sx >= x && sx < x + w && sy >= y && sy < y + h) {
+                if (crosshair[j + 8*i] & 0x1) {
+                    white[n_white].x = sx;
+                    white[n_white].y = sy;
+                    n_white++;
+                } else {
+                    black[n_black].x = sx;
+                    black[n_black].y = sy;
+                    n_black++;
                 }
             }
         }
     }
+
+    if (n_white > 0) {
+        gdk_draw_points (widget->parent->window, widget->style->white_gc, white, n_white);
+    }
+
+    if (n_black > 0) {
+        gdk_draw_points (widget->parent->window, widget->style->black_gc, black, n_black);
+    }
+
+    if (n_white > 0 || n_black > 0) {
+        record_drawn_marker (&priv->drawn_crosshair, &rect, x, y, w, h);
+    }
 }
 
 inline void 
@@ -1114,12 +1342,8 @@ inline_draw_sv_plane                            (HildonColorChooser *sel,
                                                  int h)
 {
     GtkWidget *widget = GTK_WIDGET (sel);
-    unsigned char *buf, *ptr;
-    unsigned long rgbx[3] = { 0x00ffffff, 0x00ffffff, 0x00ffffff }, rgbtmp[3];
-    signed long rgby[3];
     HildonColorChooserPrivate *priv;
-    int i, j;
-    int tmp;
+    guint32 *buf;
 
     if (w <= 0 || h <= 0) {
         return;
@@ -1127,56 +1351,30 @@ inline_draw_sv_plane                            (HildonColorChooser *sel,
 
     priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (sel);
     g_assert (priv);
-    tmp = priv->spa.width * priv->spa.height;
-
-    buf = (unsigned char *) g_malloc (w * h * 3);
-    ptr = buf;
-
-    inline_h2rgb (priv->currhue, rgbtmp);
-
-    rgby[0] = rgbtmp[0] - rgbx[0];
-    rgby[1] = rgbtmp[1] - rgbx[1];
-    rgby[2] = rgbtmp[2] - rgbx[2];
-
-    rgbx[0] /= priv->spa.width;
-    rgbx[1] /= priv->spa.width;
-    rgbx[2] /= priv->spa.width;
-
-    rgby[0] /= tmp;
-    rgby[1] /= tmp;
-    rgby[2] /= tmp;
-
-    rgbx[0] += (y - priv->spa.y) * rgby[0];
-    rgbx[1] += (y - priv->spa.y) * rgby[1];
-    rgbx[2] += (y - priv->spa.y) * rgby[2];
-
-    for(i = 0; i < h; i++) {
-        rgbtmp[0] = rgbx[0] * (x - priv->spa.x);
-        rgbtmp[1] = rgbx[1] * (x - priv->spa.x);
-        rgbtmp[2] = rgbx[2] * (x - priv->spa.x);
-
-        for(j = 0; j < w; j++) {
-            ptr[0] = rgbtmp[0] >> 16;
-            ptr[1] = rgbtmp[1] >> 16;
-            ptr[2] = rgbtmp[2] >> 16;
-            rgbtmp[0] += rgbx[0];
-            rgbtmp[1] += rgbx[1];
-            rgbtmp[2] += rgbx[2];
-            ptr += 3;
+
+    /* Only a new hue changes the plane, the crosshair is drawn over it */
+    if (priv->sv_plane == NULL || priv->sv_plane_hue != priv->currhue) {
+        buf = get_render_buffer (priv, priv->spa.width * priv->spa.height);
+
+        render_sv_plane (buf, priv->currhue, priv->spa.width, priv->spa.height,
+                0, 0, priv->spa.width, priv->spa.height);
+
+        if (priv->sv_plane == NULL) {
+            priv->sv_plane = gdk_pixmap_new (widget->window, priv->spa.width, priv->spa.height, -1);
         }
 
-        rgbx[0] += rgby[0];
-        rgbx[1] += rgby[1];
-        rgbx[2] += rgby[2];
+        gdk_draw_rgb_32_image (priv->sv_plane, widget->style->fg_gc[0], 0, 0, priv->spa.width, priv->spa.height, GDK_RGB_DITHER_NONE, (guchar *) buf, priv->spa.width * 4);
+        priv->sv_plane_hue = priv->currhue;
     }
 
-    inline_draw_crosshair (buf, 
-            (priv->spa.width * priv->currval / 0xffff) - x + priv->spa.x - 4, 
-            (priv->spa.height * priv->currsat / 0xffff) - y + priv->spa.y - 4, 
-            w, h);
+    gdk_draw_drawable (widget->parent->window, widget->style->fg_gc[0], priv->sv_plane, x - priv->spa.x, y - priv->spa.y, x, y, w, h);
 
-    gdk_draw_rgb_image (widget->parent->window, widget->style->fg_gc[0], x, y, w, h, GDK_RGB_DITHER_NONE, buf, w * 3);
-    g_free(buf);
+    /* The whole plane now shows the current hue */
+    if (x == priv->spa.x && y == priv->spa.y && w == priv->spa.width && h == priv->spa.height) {
+        priv->drawn_hue = priv->currhue;
+    }
+
+    inline_draw_crosshair (sel, x, y, w, h);
 }
 
 inline void 
@@ -1260,15 +1458,48 @@ inline_draw_sv_plane_dimmed                     (HildonColorChooser *sel,
 
 
 static gboolean 
-hildon_color_chooser_expose_timer               (gpointer data)
+hildon_color_chooser_update                     (gpointer data)
 {
     HildonColorChooser *sel = HILDON_COLOR_CHOOSER (data);
     HildonColorChooserPrivate *priv = HILDON_COLOR_CHOOSER_GET_PRIVATE (sel);
+    GtkWidget *widget = GTK_WIDGET (sel);
+    GdkRegion *damage;
+    GdkRectangle rect;
 
     g_assert (priv);
 
-    if (priv->expose_info.expose_queued) {
-        gtk_widget_queue_draw (GTK_WIDGET (data));
+    priv->update_id = 0;
+    g_get_current_time (&priv->last_update_time);
+
+    if (GTK_WIDGET_DRAWABLE (widget)) {
+        /* Repaint the markers where they were and where they are now,
+         * and the whole SV plane only if the hue changed */
+        damage = gdk_region_new ();
+
+        if (priv->drawn_hue != priv->currhue) {
+            gdk_region_union_with_rect (damage, &priv->spa);
+            priv->drawn_hue = priv->currhue;
+        }
+
+        get_crosshair_rect (priv, &rect);
+        gdk_region_union_with_rect (damage, &priv->drawn_crosshair);
+        gdk_region_union_with_rect (damage, &rect);
+        priv->drawn_crosshair = rect;
+
+        get_hue_marker_rect (priv, &rect);
+        gdk_region_union_with_rect (damage, &priv->drawn_hue_marker);
+        gdk_region_union_with_rect (damage, &rect);
+        priv->drawn_hue_marker = rect;
+
+        gdk_window_invalidate_region (widget->window, damage, FALSE);
+        gdk_region_destroy (damage);
+
+        gdk_window_process_updates (widget->window, FALSE);
+    }
+
+    if (priv->color_changed) {
+        priv->color_changed = FALSE;
+        g_signal_emit (sel, color_chooser_signals[COLOR_CHANGED], 0);
     }
 
     return FALSE;
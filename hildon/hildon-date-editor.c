@@ -381,13 +381,11 @@ hildon_date_editor_set_calendar_icon_state      (HildonDateEditor *editor,
 static void 
 apply_locale_field_order                        (HildonDateEditorPrivate *priv)
 {
-    GDate locale_test_date;
     GtkWidget *delim;
     gchar buffer[256];
     gchar *iter, *delim_text;
 
-    g_date_set_dmy (&locale_test_date, 1, 2, 1970);
-    (void) g_date_strftime (buffer, sizeof (buffer), "%x", &locale_test_date);    
+    g_strlcpy (buffer, hildon_private_get_locale_info ()->date_format, sizeof (buffer));
     iter = buffer;
 
     while (*iter)
@@ -48,6 +48,7 @@
 #include <langinfo.h>
 
 #include "hildon-date-selector.h"
+#include "hildon-touch-selector-private.h"
 
 #define HILDON_DATE_SELECTOR_GET_PRIVATE(obj)                           \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), HILDON_TYPE_DATE_SELECTOR, HildonDateSelectorPrivate))
@@ -202,6 +203,310 @@ _calc_days (N_int year, N_int mm, N_int dd)
   return (_year_to_days (--year) + days_in_months[lp][mm] + dd);
 }
 
+/***************************************************************************/
+/* Tree model for the numeric columns. The rows are computed from an
+ * integer range instead of being stored, so a wide year range costs
+ * nothing at construction time. The labels are formatted on demand and
+ * kept in a small cache, as the tree view only asks for the visible
+ * rows, but asks for them repeatedly. The day column always has the
+ * labels of the 31 days and just hides the ones after the end of the
+ * month. */
+
+#define HILDON_TYPE_DATE_SELECTOR_MODEL (hildon_date_selector_model_get_type ())
+#define HILDON_DATE_SELECTOR_MODEL(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), HILDON_TYPE_DATE_SELECTOR_MODEL, HildonDateSelectorModel))
+
+#define LABEL_CACHE_SIZE 32
+
+typedef enum
+{
+  MODEL_FIELD_DAY,
+  MODEL_FIELD_YEAR
+} HildonDateSelectorModelField;
+
+typedef struct
+{
+  gint value;
+  gchar *label;
+} HildonDateSelectorModelLabel;
+
+typedef struct
+{
+  GObject parent;
+
+  gint stamp;
+
+  gint first;
+  gint n_rows;
+
+  const gchar *format;
+  HildonDateSelectorModelField field;
+
+  HildonDateSelectorModelLabel labels[LABEL_CACHE_SIZE];
+} HildonDateSelectorModel;
+
+typedef struct
+{
+  GObjectClass parent_class;
+} HildonDateSelectorModelClass;
+
+static void hildon_date_selector_model_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (HildonDateSelectorModel, hildon_date_selector_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                hildon_date_selector_model_tree_model_init))
+
+static void
+hildon_date_selector_model_finalize (GObject *object)
+{
+  HildonDateSelectorModel *model = HILDON_DATE_SELECTOR_MODEL (object);
+  gint i;
+
+  for (i = 0; i < LABEL_CACHE_SIZE; i++)
+    g_free (model->labels[i].label);
+
+  G_OBJECT_CLASS (hildon_date_selector_model_parent_class)->finalize (object);
+}
+
+static void
+hildon_date_selector_model_class_init (HildonDateSelectorModelClass *klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = hildon_date_selector_model_finalize;
+}
+
+static void
+hildon_date_selector_model_init (HildonDateSelectorModel *model)
+{
+  gint i;
+
+  do {
+    model->stamp = g_random_int ();
+  } while (model->stamp == 0);
+
+  model->first = 0;
+  model->n_rows = 0;
+  model->format = NULL;
+  model->field = MODEL_FIELD_DAY;
+
+  for (i = 0; i < LABEL_CACHE_SIZE; i++) {
+    model->labels[i].value = 0;
+    model->labels[i].label = NULL;
+  }
+}
+
+static GtkTreeModel *
+hildon_date_selector_model_new (gint first,
+                                gint n_rows,
+                                const gchar *format,
+                                HildonDateSelectorModelField field)
+{
+  HildonDateSelectorModel *model;
+
+  model = g_object_new (HILDON_TYPE_DATE_SELECTOR_MODEL, NULL);
+  model->first = first;
+  model->n_rows = n_rows;
+  model->format = format;
+  model->field = field;
+
+  return GTK_TREE_MODEL (model);
+}
+
+static const gchar *
+hildon_date_selector_model_get_label (HildonDateSelectorModel *model,
+                                      gint value)
+{
+  HildonDateSelectorModelLabel *cached;
+  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  gchar label[255];
+
+  cached = &model->labels[(guint) value % LABEL_CACHE_SIZE];
+  if (cached->label != NULL && cached->value == value)
+    return cached->label;
+
+  if (model->field == MODEL_FIELD_YEAR)
+    tm.tm_year = value - 1900;
+  else
+    tm.tm_mday = value;
+
+  if (strftime (label, sizeof (label), model->format, &tm) == 0)
+    label[0] = '\0';
+
+  g_free (cached->label);
+  cached->label = g_strdup (label);
+  cached->value = value;
+
+  return cached->label;
+}
+
+static GtkTreeModelFlags
+hildon_date_selector_model_get_flags (GtkTreeModel *tree_model)
+{
+  return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+hildon_date_selector_model_get_n_columns (GtkTreeModel *tree_model)
+{
+  return N_COLUMNS;
+}
+
+static GType
+hildon_date_selector_model_get_column_type (GtkTreeModel *tree_model,
+                                            gint index)
+{
+  g_return_val_if_fail (index >= 0 && index < N_COLUMNS, G_TYPE_INVALID);
+
+  return index == COLUMN_STRING ? G_TYPE_STRING : G_TYPE_INT;
+}
+
+static gboolean
+hildon_date_selector_model_iter_nth_child (GtkTreeModel *tree_model,
+                                           GtkTreeIter *iter,
+                                           GtkTreeIter *parent,
+                                           gint n)
+{
+  HildonDateSelectorModel *model = HILDON_DATE_SELECTOR_MODEL (tree_model);
+
+  if (parent != NULL || n < 0 || n >= model->n_rows) {
+    iter->stamp = 0;
+    return FALSE;
+  }
+
+  iter->stamp = model->stamp;
+  iter->user_data = GINT_TO_POINTER (n);
+
+  return TRUE;
+}
+
+static gboolean
+hildon_date_selector_model_get_iter (GtkTreeModel *tree_model,
+                                     GtkTreeIter *iter,
+                                     GtkTreePath *path)
+{
+  if (gtk_tree_path_get_depth (path) != 1) {
+    iter->stamp = 0;
+    return FALSE;
+  }
+
+  return hildon_date_selector_model_iter_nth_child (tree_model, iter, NULL,
+                                                    gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath *
+hildon_date_selector_model_get_path (GtkTreeModel *tree_model,
+                                     GtkTreeIter *iter)
+{
+  g_return_val_if_fail (iter->stamp == HILDON_DATE_SELECTOR_MODEL (tree_model)->stamp, NULL);
+
+  return gtk_tree_path_new_from_indices (GPOINTER_TO_INT (iter->user_data), -1);
+}
+
+static void
+hildon_date_selector_model_get_value (GtkTreeModel *tree_model,
+                                      GtkTreeIter *iter,
+                                      gint column,
+                                      GValue *value)
+{
+  HildonDateSelectorModel *model = HILDON_DATE_SELECTOR_MODEL (tree_model);
+  gint row_value;
+
+  g_return_if_fail (iter->stamp == model->stamp);
+  g_return_if_fail (column >= 0 && column < N_COLUMNS);
+
+  row_value = model->first + GPOINTER_TO_INT (iter->user_data);
+
+  if (column == COLUMN_STRING) {
+    g_value_init (value, G_TYPE_STRING);
+    g_value_set_string (value, hildon_date_selector_model_get_label (model, row_value));
+  } else {
+    g_value_init (value, G_TYPE_INT);
+    g_value_set_int (value, row_value);
+  }
+}
+
+static gboolean
+hildon_date_selector_model_iter_next (GtkTreeModel *tree_model,
+                                      GtkTreeIter *iter)
+{
+  return hildon_date_selector_model_iter_nth_child (tree_model, iter, NULL,
+                                                    GPOINTER_TO_INT (iter->user_data) + 1);
+}
+
+static gboolean
+hildon_date_selector_model_iter_children (GtkTreeModel *tree_model,
+                                          GtkTreeIter *iter,
+                                          GtkTreeIter *parent)
+{
+  return hildon_date_selector_model_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+hildon_date_selector_model_iter_has_child (GtkTreeModel *tree_model,
+                                           GtkTreeIter *iter)
+{
+  return FALSE;
+}
+
+static gint
+hildon_date_selector_model_iter_n_children (GtkTreeModel *tree_model,
+                                            GtkTreeIter *iter)
+{
+  return iter == NULL ? HILDON_DATE_SELECTOR_MODEL (tree_model)->n_rows : 0;
+}
+
+static gboolean
+hildon_date_selector_model_iter_parent (GtkTreeModel *tree_model,
+                                        GtkTreeIter *iter,
+                                        GtkTreeIter *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
+
+/* Shows the rows up to @n_rows. Only the rows that appear or disappear
+   are signalled, nothing is formatted or allocated. */
+static void
+hildon_date_selector_model_set_n_rows (HildonDateSelectorModel *model,
+                                       gint n_rows)
+{
+  GtkTreePath *path;
+  GtkTreeIter iter;
+
+  while (model->n_rows > n_rows) {
+    model->n_rows--;
+    path = gtk_tree_path_new_from_indices (model->n_rows, -1);
+    gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+    gtk_tree_path_free (path);
+  }
+
+  while (model->n_rows < n_rows) {
+    model->n_rows++;
+    path = gtk_tree_path_new_from_indices (model->n_rows - 1, -1);
+    hildon_date_selector_model_iter_nth_child (GTK_TREE_MODEL (model), &iter,
+                                               NULL, model->n_rows - 1);
+    gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+    gtk_tree_path_free (path);
+  }
+}
+
+static void
+hildon_date_selector_model_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = hildon_date_selector_model_get_flags;
+  iface->get_n_columns = hildon_date_selector_model_get_n_columns;
+  iface->get_column_type = hildon_date_selector_model_get_column_type;
+  iface->get_iter = hildon_date_selector_model_get_iter;
+  iface->get_path = hildon_date_selector_model_get_path;
+  iface->get_value = hildon_date_selector_model_get_value;
+  iface->iter_next = hildon_date_selector_model_iter_next;
+  iface->iter_children = hildon_date_selector_model_iter_children;
+  iface->iter_has_child = hildon_date_selector_model_iter_has_child;
+  iface->iter_n_children = hildon_date_selector_model_iter_n_children;
+  iface->iter_nth_child = hildon_date_selector_model_iter_nth_child;
+  iface->iter_parent = hildon_date_selector_model_iter_parent;
+}
+
+/***************************************************************************/
+
 static void
 hildon_date_selector_set_property (GObject      *object,
                                    guint         prop_id,
@@ -535,48 +840,16 @@ _init_column_order (HildonDateSelector * selector)
 static GtkTreeModel *
 _create_day_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_days = NULL;
-  gint i = 0;
-  gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-  GtkTreeIter iter;
-
-  store_days = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
-  for (i = 1; i < 32; i++) {
-    tm.tm_mday = i;
-    strftime (label, 255, _("wdgt_va_day_numeric"), &tm);
-
-    gtk_list_store_append (store_days, &iter);
-    gtk_list_store_set (store_days, &iter,
-                        COLUMN_STRING, label, COLUMN_INT, i, -1);
-  }
-
-  return GTK_TREE_MODEL (store_days);
+  return hildon_date_selector_model_new (1, 31, _("wdgt_va_day_numeric"),
+                                         MODEL_FIELD_DAY);
 }
 
 static GtkTreeModel *
 _create_year_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_years = NULL;
-  gint real_year = 0;
-  gint i = 0;
-  static gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-  GtkTreeIter iter;
-
-  real_year = selector->priv->creation_year;
-
-  store_years = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
-  for (i = selector->priv->min_year; i < selector->priv->max_year + 1; i++) {
-    tm.tm_year = i - 1900;
-    strftime (label, 255, _("wdgt_va_year"), &tm);
-
-    gtk_list_store_append (store_years, &iter);
-    gtk_list_store_set (store_years, &iter,
-                        COLUMN_STRING, label, COLUMN_INT, i, -1);
-  }
-
-  return GTK_TREE_MODEL (store_years);
+  return hildon_date_selector_model_new (selector->priv->min_year,
+                                         selector->priv->max_year - selector->priv->min_year + 1,
+                                         _("wdgt_va_year"), MODEL_FIELD_YEAR);
 }
 
 static GtkTreeModel *
@@ -605,12 +878,7 @@ _create_month_model (HildonDateSelector * selector)
 static GtkTreeModel *
 _update_day_model (HildonDateSelector * selector)
 {
-  GtkListStore *store_days = NULL;
-  GtkTreePath *path = NULL;
-  gint i = 0;
   GtkTreeIter iter;
-  static gchar label[255];
-  struct tm tm = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
   guint current_day = 0;
   guint current_year = 0;
   guint current_month = 0;
@@ -620,31 +888,17 @@ _update_day_model (HildonDateSelector * selector)
                                  &current_day);
 
   num_days = _month_days (current_month, current_year);
-  store_days = GTK_LIST_STORE (selector->priv->day_model);
 
   if (num_days == selector->priv->current_num_days) {
-    return GTK_TREE_MODEL (store_days);
-  }
-
-  if (num_days > selector->priv->current_num_days) {
-    for (i = selector->priv->current_num_days + 1; i <= num_days; i++) {
-      tm.tm_mday = i;
-      strftime (label, 255, _("wdgt_va_day_numeric"), &tm);
-
-      gtk_list_store_append (store_days, &iter);
-      gtk_list_store_set (store_days, &iter,
-                          COLUMN_STRING, label, COLUMN_INT, i, -1);
-    }
-  } else {
-    path = gtk_tree_path_new_from_indices (num_days,
-                                           -1);
-    gtk_tree_model_get_iter (GTK_TREE_MODEL (store_days), &iter, path);
-    do {
-    }while (gtk_list_store_remove (store_days, &iter));
-
-    gtk_tree_path_free (path);
+    return selector->priv->day_model;
   }
 
+  /* The rows that appear or disappear would make the selector emit
+     "changed" once per row, the day is selected again afterwards */
+  hildon_touch_selector_block_changed (HILDON_TOUCH_SELECTOR (selector));
+  hildon_date_selector_model_set_n_rows (HILDON_DATE_SELECTOR_MODEL (selector->priv->day_model),
+                                         num_days);
+  hildon_touch_selector_unblock_changed (HILDON_TOUCH_SELECTOR (selector));
 
   selector->priv->current_num_days = num_days;
 
@@ -653,9 +907,16 @@ _update_day_model (HildonDateSelector * selector)
     current_day = num_days;
   }
 
-  hildon_date_selector_select_day (selector, current_day);
+  /* Only the day column changes, so there's no need to select the
+     whole date again */
+  if (gtk_tree_model_iter_nth_child (selector->priv->day_model, &iter, NULL,
+                                     current_day - 1)) {
+    hildon_touch_selector_select_iter (HILDON_TOUCH_SELECTOR (selector),
+                                       selector->priv->day_column, &iter,
+                                       FALSE);
+  }
 
-  return GTK_TREE_MODEL (store_days);
+  return selector->priv->day_model;
 }
 
 
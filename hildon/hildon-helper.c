@@ -177,97 +177,169 @@ attach_new_color_element                        (GtkWidget *widget,
     return style_list;
 }
 
-static void 
-hildon_change_style_recursive_from_list         (GtkWidget *widget, 
-                                                 GtkStyle *prev_style, 
+/* Builds a single modifier style with all the logical fonts and colors
+ * in @list, as they are defined in the current style of @widget. */
+static GtkRcStyle *
+hildon_logical_element_list_get_rc_style        (GtkWidget *widget,
                                                  GSList *list)
 {
-    g_assert (GTK_IS_WIDGET (widget));
-
-    /* Change the style for child widgets */
-    if (GTK_IS_CONTAINER (widget)) {
-        GList *iterator, *children;
-        children = gtk_container_get_children (GTK_CONTAINER (widget));
-        for (iterator = children; iterator != NULL; iterator = g_list_next (iterator))
-            hildon_change_style_recursive_from_list (GTK_WIDGET (iterator->data), prev_style, list);
-        g_list_free (children);
-    }
-
-    /* gtk_widget_modify_*() emit "style_set" signals, so if we got here from
-       "style_set" signal, we need to block this function from being called
-       again or we get into inifinite loop.
+    GtkRcStyle *rc_style = gtk_rc_style_new ();
+    gboolean empty = TRUE;
+    GSList *iterator;
 
-    FIXME: Compiling with gcc > 3.3 and -pedantic won't allow
-    conversion between function and object pointers. GLib API however
-    requires an object pointer for a function, so we have to work
-    around this.
-    See http://bugzilla.gnome.org/show_bug.cgi?id=310175
-    */
+    gtk_widget_ensure_style (widget);
 
-    G_GNUC_EXTENSION
-        g_signal_handlers_block_matched (G_OBJECT (widget), G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_FUNC,
-                g_signal_lookup ("style_set", G_TYPE_FROM_INSTANCE (widget)),
-                0, NULL,
-                (gpointer) hildon_change_style_recursive_from_list,
-                NULL);
-
-    /* We iterate over all list elements and apply each style
-     * specification. */
-
-    GSList *iterator = list;
-    while (iterator) {
-    
+    for (iterator = list; iterator != NULL; iterator = iterator->next) {
         HildonLogicalElement *element = (HildonLogicalElement *) iterator->data;
 
         if (element->is_color == TRUE) {
 
             /* Changing logical color */
             GdkColor color;
-            gtk_widget_ensure_style (widget);
             if (gtk_style_lookup_color (widget->style, element->logical_color_name, &color) == TRUE) {
-               
+
                 switch (element->rc_flags)
                 {
                     case GTK_RC_FG:
-                        gtk_widget_modify_fg (widget, element->state, &color);
+                        rc_style->fg[element->state] = color;
                         break;
 
                     case GTK_RC_BG:
-                        gtk_widget_modify_bg (widget, element->state, &color);
+                        rc_style->bg[element->state] = color;
                         break;
 
                     case GTK_RC_TEXT:
-                        gtk_widget_modify_text (widget, element->state, &color);
+                        rc_style->text[element->state] = color;
                         break;
 
                     case GTK_RC_BASE:
-                        gtk_widget_modify_base (widget, element->state, &color);
+                        rc_style->base[element->state] = color;
                         break;
+
+                    default:
+                        continue;
                 }
+
+                rc_style->color_flags[element->state] |= element->rc_flags;
+                empty = FALSE;
             }
         } else {
-            
+
             /* Changing logical font */
             GtkStyle *font_style = gtk_rc_get_style_by_paths (gtk_settings_get_default (), element->logical_font_name, NULL, G_TYPE_NONE);
-            if (font_style != NULL) {
-                PangoFontDescription *font_desc = font_style->font_desc;
+            if (font_style != NULL && font_style->font_desc != NULL) {
+                if (rc_style->font_desc != NULL)
+                    pango_font_description_free (rc_style->font_desc);
 
-                if (font_desc != NULL)
-                    gtk_widget_modify_font (widget, font_desc);
+                rc_style->font_desc = pango_font_description_copy (font_style->font_desc);
+                empty = FALSE;
             }
         }
+    }
 
-        iterator = iterator->next;
-    } 
+    if (empty) {
+        g_object_unref (rc_style);
+        return NULL;
+    }
+
+    return rc_style;
+}
+
+/* Copies the fields set in @rc_style over @modifier, the modifier
+ * style of a widget, so its gtk_widget_modify_*() changes are kept */
+static void
+hildon_merge_rc_style                           (GtkRcStyle *modifier,
+                                                 GtkRcStyle *rc_style)
+{
+    gint i;
+
+    for (i = 0; i < 5; i++) {
+        GtkRcFlags flags = rc_style->color_flags[i];
+
+        if (flags & GTK_RC_FG)
+            modifier->fg[i] = rc_style->fg[i];
+        if (flags & GTK_RC_BG)
+            modifier->bg[i] = rc_style->bg[i];
+        if (flags & GTK_RC_TEXT)
+            modifier->text[i] = rc_style->text[i];
+        if (flags & GTK_RC_BASE)
+            modifier->base[i] = rc_style->base[i];
+
+        modifier->color_flags[i] |= flags;
+    }
 
-    /* FIXME: Compilation workaround for gcc > 3.3 + -pedantic again */
+    if (rc_style->font_desc != NULL) {
+        if (modifier->font_desc != NULL)
+            pango_font_description_free (modifier->font_desc);
 
-    G_GNUC_EXTENSION
-        g_signal_handlers_unblock_matched (G_OBJECT (widget), G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_FUNC,
-                g_signal_lookup ("style_set", G_TYPE_FROM_INSTANCE (widget)),
-                0, NULL,
-                (gpointer) hildon_change_style_recursive_from_list,
-                NULL);
+        modifier->font_desc = pango_font_description_copy (rc_style->font_desc);
+    }
+}
+
+static void
+hildon_change_style_recursive_from_rc_style     (GtkWidget *widget,
+                                                 gpointer rc_style)
+{
+    GtkRcStyle *modifier;
+
+    /* Change the style for child widgets */
+    if (GTK_IS_CONTAINER (widget))
+        gtk_container_foreach (GTK_CONTAINER (widget),
+                               hildon_change_style_recursive_from_rc_style, rc_style);
+
+    modifier = gtk_widget_get_modifier_style (widget);
+    hildon_merge_rc_style (modifier, rc_style);
+    gtk_widget_modify_style (widget, modifier);
+}
+
+/* The widget whose logical style is being applied, and the widgets
+ * below it with a logical style of their own, to be applied after it */
+static GtkWidget *styled_widget = NULL;
+static GSList *deferred_widgets = NULL;
+
+static void 
+hildon_change_style_recursive_from_list         (GtkWidget *widget, 
+                                                 GtkStyle *prev_style, 
+                                                 GSList *list)
+{
+    GtkRcStyle *rc_style;
+
+    g_assert (GTK_IS_WIDGET (widget));
+
+    /* gtk_widget_modify_style() emits "style_set" signals, so if we got
+       here from one of the changes we are making, we ignore it or we get
+       into an infinite loop. Other widgets of the subtree with a logical
+       style re-apply it on top of this one, but only once this pass is
+       over instead of from within it. */
+    if (styled_widget != NULL) {
+        if (widget != styled_widget && g_slist_find (deferred_widgets, widget) == NULL)
+            deferred_widgets = g_slist_append (deferred_widgets, g_object_ref (widget));
+        return;
+    }
+
+    /* The logical names are resolved once for the whole subtree, and
+       each widget gets all of them in a single style change */
+    rc_style = hildon_logical_element_list_get_rc_style (widget, list);
+    if (rc_style != NULL) {
+        styled_widget = widget;
+        hildon_change_style_recursive_from_rc_style (widget, rc_style);
+        styled_widget = NULL;
+
+        g_object_unref (rc_style);
+    }
+
+    while (deferred_widgets != NULL) {
+        GtkWidget *deferred = deferred_widgets->data;
+        GSList *deferred_list;
+
+        deferred_widgets = g_slist_delete_link (deferred_widgets, deferred_widgets);
+
+        deferred_list = g_object_get_qdata (G_OBJECT (deferred), hildon_helper_logical_data_quark ());
+        if (deferred_list != NULL)
+            hildon_change_style_recursive_from_list (deferred, NULL, deferred_list);
+
+        g_object_unref (deferred);
+    }
 }
 
 /**
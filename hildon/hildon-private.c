@@ -28,6 +28,11 @@
 #include                                        <config.h>
 #endif
 
+#include                                        <string.h>
+#include                                        <locale.h>
+#include                                        <langinfo.h>
+#include                                        <gconf/gconf-client.h>
+
 #include                                        "hildon-private.h"
 #include                                        "hildon-date-editor.h"
 #include                                        "hildon-time-editor.h"
@@ -80,42 +85,105 @@ hildon_private_composite_focus                  (GtkWidget *widget,
 }
 
 
-G_GNUC_INTERNAL GtkWidget *
-hildon_private_create_animation                 (gfloat       framerate,
-                                                 const gchar *template,
-                                                 gint         nframes)
+/*
+ * Decoded animation frames, shared by every animation created with the
+ * same template, size and number of frames. Progress banners are shown
+ * often, and they would otherwise look up and decode the same icons
+ * each time. The cache is emptied when the icon theme changes.
+ */
+static GHashTable *animation_frames = NULL;
+
+static void
+hildon_private_free_animation_frames            (gpointer data)
 {
-    GtkWidget *image;
-    GdkPixbufSimpleAnim *anim;
-    GtkIconTheme *theme;
+    GPtrArray *frames = data;
+    guint i;
+
+    for (i = 0; i < frames->len; i++)
+        g_object_unref (g_ptr_array_index (frames, i));
+
+    g_ptr_array_free (frames, TRUE);
+}
+
+static void
+hildon_private_icon_theme_changed               (GtkIconTheme *theme,
+                                                 gpointer      data)
+{
+    g_hash_table_remove_all (animation_frames);
+}
+
+static GPtrArray *
+hildon_private_get_animation_frames             (GtkIconTheme *theme,
+                                                 const gchar  *template,
+                                                 gint          size,
+                                                 gint          nframes)
+{
+    GPtrArray *frames;
+    gchar *key;
     gint i;
 
-    anim = gdk_pixbuf_simple_anim_new (HILDON_ICON_PIXEL_SIZE_STYLUS,
-                                       HILDON_ICON_PIXEL_SIZE_STYLUS,
-                                       framerate);
-    gdk_pixbuf_simple_anim_set_loop (anim, TRUE);
-    theme = gtk_icon_theme_get_default ();
+    if (animation_frames == NULL) {
+        animation_frames = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                  hildon_private_free_animation_frames);
+        g_signal_connect (theme, "changed",
+                          G_CALLBACK (hildon_private_icon_theme_changed), NULL);
+    }
+
+    key = g_strdup_printf ("%s:%d:%d", template, size, nframes);
+
+    frames = g_hash_table_lookup (animation_frames, key);
+    if (frames != NULL) {
+        g_free (key);
+        return frames;
+    }
+
+    frames = g_ptr_array_sized_new (nframes);
 
     for (i = 1; i <= nframes; i++) {
         GdkPixbuf *frame;
         GError *error = NULL;
         gchar *icon_name = g_strdup_printf (template, i);
-        frame = gtk_icon_theme_load_icon (theme, icon_name,
-                                          HILDON_ICON_PIXEL_SIZE_STYLUS,
-                                          0, &error);
+        frame = gtk_icon_theme_load_icon (theme, icon_name, size, 0, &error);
 
         if (error) {
             g_warning ("Icon theme lookup for icon `%s' failed: %s",
                        icon_name, error->message);
             g_error_free (error);
         } else {
-            gdk_pixbuf_simple_anim_add_frame (anim, frame);
+            g_ptr_array_add (frames, frame);
         }
 
-        g_object_unref (frame);
         g_free (icon_name);
     }
 
+    g_hash_table_insert (animation_frames, key, frames);
+
+    return frames;
+}
+
+G_GNUC_INTERNAL GtkWidget *
+hildon_private_create_animation                 (gfloat       framerate,
+                                                 const gchar *template,
+                                                 gint         nframes)
+{
+    GtkWidget *image;
+    GdkPixbufSimpleAnim *anim;
+    GPtrArray *frames;
+    guint i;
+
+    anim = gdk_pixbuf_simple_anim_new (HILDON_ICON_PIXEL_SIZE_STYLUS,
+                                       HILDON_ICON_PIXEL_SIZE_STYLUS,
+                                       framerate);
+    gdk_pixbuf_simple_anim_set_loop (anim, TRUE);
+
+    frames = hildon_private_get_animation_frames (gtk_icon_theme_get_default (),
+                                                  template,
+                                                  HILDON_ICON_PIXEL_SIZE_STYLUS,
+                                                  nframes);
+
+    for (i = 0; i < frames->len; i++)
+        gdk_pixbuf_simple_anim_add_frame (anim, g_ptr_array_index (frames, i));
+
     image = gtk_image_new_from_animation (GDK_PIXBUF_ANIMATION (anim));
     g_object_unref (anim);
 
@@ -155,3 +223,222 @@ hildon_gtk_window_set_flag                                        (GtkWindow
          g_signal_connect (window, "realize", G_CALLBACK (func), userdata);
      }
 }
+
+/*
+ * Registry of the widgets whose state lives in the compositing window
+ * manager (animation actors and remote textures). When the window
+ * manager restarts, every such widget is told to send its state again.
+ * Instead of each of them doing it at once, the resending is done here
+ * for all of them, in two stages -- the geometry of every client first,
+ * then parents and visibility -- and a limited number of clients per
+ * frame.
+ */
+
+#define                                         WM_RESEND_INTERVAL 16
+
+#define                                         WM_RESEND_BATCH 16
+
+static GHashTable *wm_clients = NULL;
+static GQueue wm_resend_queue[HILDON_WM_CLIENT_RESEND_N_STAGES] = { G_QUEUE_INIT, G_QUEUE_INIT };
+static guint wm_resend_id = 0;
+
+G_GNUC_INTERNAL void
+hildon_private_wm_client_register               (GtkWidget                *widget,
+                                                 HildonWMClientResendFunc  func)
+{
+    if (wm_clients == NULL)
+        wm_clients = g_hash_table_new (NULL, NULL);
+
+    g_hash_table_insert (wm_clients, widget, func);
+}
+
+G_GNUC_INTERNAL void
+hildon_private_wm_client_unregister             (GtkWidget *widget)
+{
+    gint i;
+
+    g_hash_table_remove (wm_clients, widget);
+
+    for (i = 0; i < HILDON_WM_CLIENT_RESEND_N_STAGES; i++)
+        g_queue_remove (&wm_resend_queue[i], widget);
+}
+
+static gboolean
+hildon_private_wm_client_resend                 (gpointer data)
+{
+    gint budget = WM_RESEND_BATCH;
+    gint stage;
+
+    for (stage = 0; stage < HILDON_WM_CLIENT_RESEND_N_STAGES && budget > 0; stage++)
+    {
+        while (budget > 0 && !g_queue_is_empty (&wm_resend_queue[stage]))
+        {
+            GtkWidget *widget = g_queue_pop_head (&wm_resend_queue[stage]);
+            HildonWMClientResendFunc func = g_hash_table_lookup (wm_clients, widget);
+
+            (*func) (widget, stage);
+
+            if (stage + 1 < HILDON_WM_CLIENT_RESEND_N_STAGES)
+                g_queue_push_tail (&wm_resend_queue[stage + 1], widget);
+
+            budget--;
+        }
+
+        /* Don't start a stage until the previous one is complete */
+        if (!g_queue_is_empty (&wm_resend_queue[stage]))
+            break;
+    }
+
+    for (stage = 0; stage < HILDON_WM_CLIENT_RESEND_N_STAGES; stage++)
+        if (!g_queue_is_empty (&wm_resend_queue[stage]))
+            return TRUE;
+
+    wm_resend_id = 0;
+    return FALSE;
+}
+
+/*
+ * Schedules @widget, which must be registered, to send all its state
+ * to the window manager again.
+ */
+G_GNUC_INTERNAL void
+hildon_private_wm_client_queue_resend           (GtkWidget *widget)
+{
+    gint i;
+
+    g_return_if_fail (g_hash_table_lookup (wm_clients, widget) != NULL);
+
+    /* Restart from the first stage if it was already queued */
+    for (i = 0; i < HILDON_WM_CLIENT_RESEND_N_STAGES; i++)
+        g_queue_remove (&wm_resend_queue[i], widget);
+
+    g_queue_push_tail (&wm_resend_queue[HILDON_WM_CLIENT_RESEND_GEOMETRY], widget);
+
+    if (wm_resend_id == 0)
+        wm_resend_id = gdk_threads_add_timeout (WM_RESEND_INTERVAL,
+                                                hildon_private_wm_client_resend,
+                                                NULL);
+}
+
+/*
+ * Locale data used by the date and time widgets. Formatting the test
+ * date and asking nl_langinfo() for every new editor is wasted work in
+ * dialogs with several of them, so it is done once and redone only when
+ * LC_TIME changes.
+ */
+
+static HildonLocaleInfo locale_info = { NULL, NULL, NULL, NULL, NULL, FALSE };
+
+static void
+hildon_private_locale_info_clear                (HildonLocaleInfo *info)
+{
+    g_free (info->locale);
+    g_free (info->time_format);
+    g_free (info->date_format);
+    g_free (info->am_symbol);
+    g_free (info->pm_symbol);
+}
+
+/*
+ * Returns the cached locale data. The strings are owned by hildon and
+ * are only valid until the next call that sees a different LC_TIME.
+ *
+ * time_format and date_format are the 1st of February 1970 formatted
+ * with "%X" and "%x", for the widgets that find the field order and the
+ * separators in them.
+ */
+G_GNUC_INTERNAL const HildonLocaleInfo *
+hildon_private_get_locale_info                  (void)
+{
+    const gchar *locale;
+    GDate locale_test_date;
+    gchar buffer[256];
+
+    locale = setlocale (LC_TIME, NULL);
+    if (locale == NULL)
+        locale = "C";
+
+    if (locale_info.locale != NULL && strcmp (locale_info.locale, locale) == 0)
+        return &locale_info;
+
+    hildon_private_locale_info_clear (&locale_info);
+    locale_info.locale = g_strdup (locale);
+
+    g_date_set_dmy (&locale_test_date, 1, 2, 1970);
+    (void) g_date_strftime (buffer, sizeof (buffer), "%X", &locale_test_date);
+    locale_info.time_format = g_strdup (buffer);
+    (void) g_date_strftime (buffer, sizeof (buffer), "%x", &locale_test_date);
+    locale_info.date_format = g_strdup (buffer);
+
+    locale_info.am_symbol = g_strdup (nl_langinfo (AM_STR));
+    locale_info.pm_symbol = g_strdup (nl_langinfo (PM_STR));
+
+    /* %p is the AM/PM string, so we assume that if the format string
+       begins with %p it's in the beginning, and in any other case it's
+       in the end (although that's not necessarily the case). */
+    locale_info.ampm_before = strncmp (nl_langinfo (T_FMT_AMPM), "%p", 2) == 0;
+
+    return &locale_info;
+}
+
+/* FIXME: we should get this two props from the clock ui headers */
+#define                                         CLOCK_GCONF_PATH "/apps/clock"
+
+#define                                         CLOCK_GCONF_IS_24H_FORMAT CLOCK_GCONF_PATH "/time-format"
+
+static GConfClient *clock_client = NULL;
+static gboolean clock_24h = TRUE;
+
+/* An unset key reads as FALSE, as gconf_client_get_bool() does, so
+ * the 12h format is used until the clock settings say otherwise */
+static gboolean
+hildon_private_clock_value_is_24h               (const GConfValue *value)
+{
+    return (value == NULL || value->type != GCONF_VALUE_BOOL) ?
+        FALSE : gconf_value_get_bool (value);
+}
+
+static void
+hildon_private_clock_format_changed             (GConfClient *client,
+                                                 guint        cnxn_id,
+                                                 GConfEntry  *entry,
+                                                 gpointer     data)
+{
+    clock_24h = hildon_private_clock_value_is_24h (gconf_entry_get_value (entry));
+}
+
+/*
+ * Returns whether the clock settings ask for the 24h format. The value
+ * is read from GConf once and then kept up to date with a notification,
+ * so this is cheap enough to call for every new widget.
+ */
+G_GNUC_INTERNAL gboolean
+hildon_private_get_clock_24h                    (void)
+{
+    GError *error = NULL;
+    GConfValue *value;
+
+    if (clock_client != NULL)
+        return clock_24h;
+
+    clock_client = gconf_client_get_default ();
+    gconf_client_add_dir (clock_client, CLOCK_GCONF_PATH,
+                          GCONF_CLIENT_PRELOAD_NONE, NULL);
+    gconf_client_notify_add (clock_client, CLOCK_GCONF_IS_24H_FORMAT,
+                             hildon_private_clock_format_changed,
+                             NULL, NULL, NULL);
+
+    value = gconf_client_get (clock_client, CLOCK_GCONF_IS_24H_FORMAT, &error);
+    if (error != NULL) {
+        g_warning ("Error trying to get gconf variable %s, using 12h format by default",
+                   CLOCK_GCONF_IS_24H_FORMAT);
+        g_error_free (error);
+    }
+
+    clock_24h = hildon_private_clock_value_is_24h (value);
+
+    if (value != NULL)
+        gconf_value_free (value);
+
+    return clock_24h;
+}
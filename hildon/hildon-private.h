@@ -58,6 +58,40 @@ hildon_gtk_window_set_flag                                        (GtkWindow
                                                                    HildonFlagFunc  func,
                                                                    gpointer        userdata);
 
+typedef enum {
+    HILDON_WM_CLIENT_RESEND_GEOMETRY,
+    HILDON_WM_CLIENT_RESEND_VISIBILITY,
+    HILDON_WM_CLIENT_RESEND_N_STAGES
+} HildonWMClientResendStage;
+
+typedef void (*HildonWMClientResendFunc) (GtkWidget *widget, HildonWMClientResendStage stage);
+
+G_GNUC_INTERNAL void
+hildon_private_wm_client_register               (GtkWidget                *widget,
+                                                 HildonWMClientResendFunc  func);
+
+G_GNUC_INTERNAL void
+hildon_private_wm_client_unregister             (GtkWidget *widget);
+
+G_GNUC_INTERNAL void
+hildon_private_wm_client_queue_resend           (GtkWidget *widget);
+
+typedef struct
+{
+    gchar    *locale;
+    gchar    *time_format;
+    gchar    *date_format;
+    gchar    *am_symbol;
+    gchar    *pm_symbol;
+    gboolean  ampm_before;
+} HildonLocaleInfo;
+
+G_GNUC_INTERNAL const HildonLocaleInfo *
+hildon_private_get_locale_info                  (void);
+
+G_GNUC_INTERNAL gboolean
+hildon_private_get_clock_24h                    (void);
+
 G_END_DECLS
 
 #endif                                          /* __HILDON_PRIVATE_H__ */
@@ -33,6 +33,20 @@ G_BEGIN_DECLS
 
 typedef struct                                  _HildonRemoteTexturePrivate HildonRemoteTexturePrivate;
 
+/* Maximum number of separate damaged rectangles kept between frames */
+#define                                         HILDON_REMOTE_TEXTURE_MAX_DAMAGE 4
+
+#define                                         HILDON_REMOTE_TEXTURE_MAX_BUFFERS 3
+
+typedef struct                                  _HildonRemoteTextureBuffer HildonRemoteTextureBuffer;
+
+struct                                          _HildonRemoteTextureBuffer
+{
+    key_t   key;
+    gint    id;
+    guchar *data;
+};
+
 #define                                         HILDON_REMOTE_TEXTURE_GET_PRIVATE(obj) \
                                                 (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
                                                 HILDON_TYPE_REMOTE_TEXTURE, HildonRemoteTexturePrivate));
@@ -54,10 +68,22 @@ struct                                          _HildonRemoteTexturePrivate
     guint   shm_height;
     guint   shm_bpp;
 
-    gint    damage_x1;
-    gint    damage_y1;
-    gint    damage_x2;
-    gint    damage_y2;
+    GdkRectangle damage[HILDON_REMOTE_TEXTURE_MAX_DAMAGE];
+    guint   n_damage;
+    guint   damage_flush_id;
+    GTimeVal damage_flush_time;
+
+    guint64 pixels_changed;
+    guint64 pixels_reported;
+
+    /* Buffers owned by the texture, see hildon_remote_texture_create_buffers() */
+    HildonRemoteTextureBuffer buffers[HILDON_REMOTE_TEXTURE_MAX_BUFFERS];
+    guint   n_buffers;
+    guint   back_buffer;
+    guint   buffer_width;
+    guint   buffer_height;
+    guint   buffer_bpp;
+    guint   in_frame : 1;
 
     guint   show;
     guint   opacity;
@@ -75,7 +101,6 @@ struct                                          _HildonRemoteTexturePrivate
 
     GtkWindow* parent;
     gulong  parent_map_event_cb_id;
-
     gulong  map_event_cb_id;
 };
 
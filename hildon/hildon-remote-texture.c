@@ -30,13 +30,24 @@
  * The #HildonRemoteTexture is a GTK+ widget which allows the rendering of
  * a shared memory area within hildon-desktop. It allows the memory area to
  * be positioned and scaled, without altering its' contents.
+ *
+ * The shared memory area can be created by the application and set with
+ * hildon_remote_texture_set_image(), or be owned by the remote texture
+ * itself with hildon_remote_texture_create_buffers(). In the latter case,
+ * each frame is drawn between hildon_remote_texture_begin_frame() and
+ * hildon_remote_texture_end_frame() into a buffer that hildon-desktop is
+ * not reading.
  */
 
+#include                                        <sys/ipc.h>
+#include                                        <sys/shm.h>
+
 #include                                        <gdk/gdkx.h>
 #include                                        <X11/Xatom.h>
 
 #include                                        "hildon-remote-texture.h"
 #include                                        "hildon-remote-texture-private.h"
+#include                                        "hildon-private.h"
 
 G_DEFINE_TYPE (HildonRemoteTexture, hildon_remote_texture, GTK_TYPE_WINDOW);
 
@@ -49,15 +60,22 @@ hildon_remote_texture_update_ready (HildonRemoteTexture *self);
 static void
 hildon_remote_texture_send_pending_messages (HildonRemoteTexture *self);
 static void
-hildon_remote_texture_send_all_messages (HildonRemoteTexture *self);
+hildon_remote_texture_resend (GtkWidget *widget,
+                              HildonWMClientResendStage stage);
+static gboolean
+hildon_remote_texture_can_send_messages (HildonRemoteTexture *self);
+static void
+hildon_remote_texture_send_damage (HildonRemoteTexture *self);
+static void
+hildon_remote_texture_destroy_buffers (HildonRemoteTexture *self);
+static gboolean
+hildon_remote_texture_map_event (GtkWidget *widget,
+                                 GdkEvent *event,
+                                 gpointer user_data);
 static gboolean
 hildon_remote_texture_parent_map_event (GtkWidget *parent,
 					 GdkEvent *event,
 					 gpointer user_data);
-static gboolean
-hildon_remote_texture_map_event (GtkWidget *widget,
-				  GdkEvent *event,
-				  gpointer user_data);
 
 static guint32 shm_atom;
 static guint32 damage_atom;
@@ -183,6 +201,15 @@ hildon_remote_texture_finalize                (GObject *object)
 
         g_object_unref (priv->parent);
     }
+
+    if (priv->damage_flush_id)
+        g_source_remove (priv->damage_flush_id);
+
+    hildon_remote_texture_destroy_buffers (self);
+
+    hildon_private_wm_client_unregister (GTK_WIDGET (self));
+
+    G_OBJECT_CLASS (hildon_remote_texture_parent_class)->finalize (object);
 }
 
 static void
@@ -212,6 +239,26 @@ hildon_remote_texture_init                    (HildonRemoteTexture *self)
     priv->scale_x = 1;
     priv->scale_y = 1;
     priv->opacity = 0xff;
+
+    hildon_private_wm_client_register (GTK_WIDGET (self),
+                                       hildon_remote_texture_resend);
+}
+
+static void
+hildon_remote_texture_destroy_buffers (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate
+                       *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+    guint i;
+
+    for (i = 0; i < priv->n_buffers; i++)
+    {
+        shmdt (priv->buffers[i].data);
+        shmctl (priv->buffers[i].id, IPC_RMID, NULL);
+    }
+
+    priv->n_buffers = 0;
+    priv->in_frame = 0;
 }
 
 /**
@@ -313,14 +360,16 @@ hildon_remote_texture_update_ready (HildonRemoteTexture *self)
     {
 	/* The ready flag has been set once already. This means that
 	 * the WM has restarted. Trigger re-mapping of the widget to
-	 * update the texture actor first. Then push all remote
-	 * texture settings anew. */
+	 * update the texture actor first. Then, once the WM has
+	 * mapped it again, push all remote texture settings anew,
+	 * together with the other actors and textures that need it. */
 
-	priv->map_event_cb_id =
-	    g_signal_connect (G_OBJECT (self),
-			      "map-event",
-			      G_CALLBACK(hildon_remote_texture_map_event),
-			      self);
+	if (priv->map_event_cb_id == 0)
+	    priv->map_event_cb_id =
+		g_signal_connect (G_OBJECT (self),
+				  "map-event",
+				  G_CALLBACK(hildon_remote_texture_map_event),
+				  self);
 
 	if (GTK_WIDGET_MAPPED (GTK_WIDGET (self)))
 	{
@@ -350,12 +399,9 @@ hildon_remote_texture_send_pending_messages (HildonRemoteTexture *self)
                                       priv->shm_width, priv->shm_height,
                                       priv->shm_bpp);
 
-    if (priv->set_damage)
-      hildon_remote_texture_update_area (self,
-                                         priv->damage_x1,
-                                         priv->damage_y1,
-                                         priv->damage_x2 - priv->damage_x1,
-                                         priv->damage_y2 - priv->damage_y1);
+    if (priv->set_damage &&
+        hildon_remote_texture_can_send_messages (self))
+      hildon_remote_texture_send_damage (self);
 
     if (priv->set_position)
 	hildon_remote_texture_set_position (self,
@@ -383,18 +429,36 @@ hildon_remote_texture_send_pending_messages (HildonRemoteTexture *self)
 					      priv->show, priv->opacity);
 }
 
+/*
+ * Called by the WM client registry to send the whole state again after
+ * a WM restart. The geometry of every client is sent first, and only
+ * then the parent and visibility, so that nothing shows up in a stale
+ * place.
+ */
 static void
-hildon_remote_texture_send_all_messages (HildonRemoteTexture *self)
+hildon_remote_texture_resend (GtkWidget *widget,
+                              HildonWMClientResendStage stage)
 {
+    HildonRemoteTexture        *self = HILDON_REMOTE_TEXTURE (widget);
     HildonRemoteTexturePrivate
 	               *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
 
-    priv->set_shm = 1;
-    priv->set_damage = 1;
-    priv->set_position = 1;
-    priv->set_scale = 1;
-    priv->set_parent = 1;
-    priv->set_show = 1;
+    if (stage == HILDON_WM_CLIENT_RESEND_GEOMETRY)
+    {
+	if (priv->shm_width > 0 && priv->shm_height > 0)
+	    hildon_remote_texture_update_area (self, 0, 0,
+					       priv->shm_width,
+					       priv->shm_height);
+	priv->set_shm = 1;
+	priv->set_position = 1;
+	priv->set_offset = 1;
+	priv->set_scale = 1;
+    }
+    else
+    {
+	priv->set_parent = 1;
+	priv->set_show = 1;
+    }
 
     hildon_remote_texture_send_pending_messages (self);
 }
@@ -503,6 +567,178 @@ hildon_remote_texture_set_image (HildonRemoteTexture *self,
     }
 }
 
+/*
+ * Damage is kept as a short list of disjoint rectangles. Two areas are
+ * merged when the pixels their bounding box adds are cheaper to upload
+ * than sending a separate damage message; when the list is full, the
+ * cheapest pair is merged regardless.
+ */
+
+#define                                         DAMAGE_MESSAGE_COST 4096
+
+#define                                         DAMAGE_FRAME_INTERVAL 16
+
+static guint64
+rectangle_area (const GdkRectangle *rect)
+{
+    return (guint64) rect->width * rect->height;
+}
+
+/* Pixels that would be needlessly reported if @a and @b were merged */
+static gint64
+damage_merge_waste (const GdkRectangle *a,
+                    const GdkRectangle *b)
+{
+    GdkRectangle u, i;
+    gint64 waste;
+
+    gdk_rectangle_union (a, b, &u);
+    waste = rectangle_area (&u) - rectangle_area (a) - rectangle_area (b);
+
+    if (gdk_rectangle_intersect (a, b, &i))
+        waste += rectangle_area (&i);
+
+    return waste;
+}
+
+static void
+hildon_remote_texture_add_damage (HildonRemoteTexture *self,
+                                  GdkRectangle *rect)
+{
+    HildonRemoteTexturePrivate
+                       *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+    GdkRectangle *damage = priv->damage;
+    gint64 waste, best_waste;
+    guint i, j, best_i, best_j;
+    GdkRectangle area = *rect;
+
+    /* Absorb every rectangle that is cheap to merge with the new one */
+    for (;;)
+    {
+        best_i = priv->n_damage;
+        best_waste = DAMAGE_MESSAGE_COST;
+
+        for (i = 0; i < priv->n_damage; i++)
+        {
+            waste = damage_merge_waste (&area, &damage[i]);
+            if (waste <= best_waste)
+            {
+                best_waste = waste;
+                best_i = i;
+            }
+        }
+
+        if (best_i == priv->n_damage)
+            break;
+
+        gdk_rectangle_union (&area, &damage[best_i], &area);
+        damage[best_i] = damage[--priv->n_damage];
+    }
+
+    if (priv->n_damage < HILDON_REMOTE_TEXTURE_MAX_DAMAGE)
+    {
+        damage[priv->n_damage++] = area;
+        return;
+    }
+
+    /* The list is full: merge the new area into the cheapest place,
+     * which may be a pair of existing rectangles */
+    best_i = best_j = priv->n_damage;
+    best_waste = G_MAXINT64;
+
+    for (i = 0; i < priv->n_damage; i++)
+    {
+        waste = damage_merge_waste (&area, &damage[i]);
+        if (waste < best_waste)
+        {
+            best_waste = waste;
+            best_i = i;
+            best_j = priv->n_damage;
+        }
+
+        for (j = i + 1; j < priv->n_damage; j++)
+        {
+            waste = damage_merge_waste (&damage[i], &damage[j]);
+            if (waste < best_waste)
+            {
+                best_waste = waste;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+
+    if (best_j == priv->n_damage)
+    {
+        gdk_rectangle_union (&damage[best_i], &area, &damage[best_i]);
+    }
+    else
+    {
+        gdk_rectangle_union (&damage[best_i], &damage[best_j], &damage[best_i]);
+        damage[best_j] = area;
+    }
+}
+
+/* Whether messages can be sent to the window manager right now. Messages
+ * are deferred until the remote texture is parented and the parent window
+ * is mapped. */
+static gboolean
+hildon_remote_texture_can_send_messages (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate
+                       *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    return GTK_WIDGET_MAPPED (GTK_WIDGET (self)) && priv->ready &&
+        priv->parent && GTK_WIDGET_MAPPED (GTK_WIDGET (priv->parent));
+}
+
+static void
+hildon_remote_texture_send_damage (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate
+                       *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+    guint i;
+
+    if (priv->damage_flush_id)
+    {
+        g_source_remove (priv->damage_flush_id);
+        priv->damage_flush_id = 0;
+    }
+
+    for (i = 0; i < priv->n_damage; i++)
+    {
+        GdkRectangle *rect = &priv->damage[i];
+
+        hildon_remote_texture_send_message (self,
+                                            damage_atom,
+                                            rect->x, rect->y,
+                                            rect->width, rect->height,
+                                            0);
+        priv->pixels_reported += rectangle_area (rect);
+    }
+
+    priv->n_damage = 0;
+    priv->set_damage = 0;
+    g_get_current_time (&priv->damage_flush_time);
+}
+
+static gboolean
+hildon_remote_texture_damage_flush (gpointer data)
+{
+    HildonRemoteTexture *self = HILDON_REMOTE_TEXTURE (data);
+    HildonRemoteTexturePrivate
+                       *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    priv->damage_flush_id = 0;
+
+    /* Otherwise the damage stays pending until the messages can be sent,
+     * or until the frame being drawn ends */
+    if (hildon_remote_texture_can_send_messages (self) && !priv->in_frame)
+        hildon_remote_texture_send_damage (self);
+
+    return FALSE;
+}
+
 /**
  * hildon_remote_texture_update_area:
  * @self: A #HildonRemoteTexture
@@ -515,6 +751,10 @@ hildon_remote_texture_set_image (HildonRemoteTexture *self,
  * has changed. This will trigger a redraw and will update the relevant tiles
  * of the texture.
  *
+ * The areas damaged during a frame are accumulated and sent together, at
+ * most once per frame. Distant areas are kept separate, so that only the
+ * tiles around them need to be updated.
+ *
  * Since: 2.2
  */
 void
@@ -526,43 +766,96 @@ hildon_remote_texture_update_area (HildonRemoteTexture *self,
 {
   HildonRemoteTexturePrivate
                      *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
-  GtkWidget          *widget = GTK_WIDGET (self);
+  GdkRectangle area = { x, y, width, height };
 
-  if (priv->damage_x1==priv->damage_x2 || priv->damage_y1==priv->damage_y2)
-    {
-      priv->damage_x1 = x;
-      priv->damage_y1 = y;
-      priv->damage_x2 = x+width;
-      priv->damage_y2 = y+height;
-    }
-  else
+  if (width <= 0 || height <= 0)
+    return;
+
+  hildon_remote_texture_add_damage (self, &area);
+  priv->pixels_changed += rectangle_area (&area);
+  priv->set_damage = 1;
+
+  /* The damage of a frame is sent by hildon_remote_texture_end_frame(),
+   * once the buffer it was drawn in is shown */
+  if (priv->in_frame)
+    return;
+
+  if (hildon_remote_texture_can_send_messages (self) && !priv->damage_flush_id)
     {
-      if (x<priv->damage_x1) priv->damage_x1 = x;
-      if (y<priv->damage_y1) priv->damage_y1 = y;
-      if (x+width>priv->damage_x2) priv->damage_x2 = x+width;
-      if (y+height>priv->damage_y2) priv->damage_y2 = y+height;
+      GTimeVal now;
+      glong elapsed;
+
+      /* Send the damage once the current batch of updates is done, but
+       * not sooner than a frame after the previous one */
+      g_get_current_time (&now);
+      elapsed = (now.tv_sec - priv->damage_flush_time.tv_sec) * 1000 +
+          (now.tv_usec - priv->damage_flush_time.tv_usec) / 1000;
+
+      if (elapsed >= 0 && elapsed < DAMAGE_FRAME_INTERVAL)
+        priv->damage_flush_id =
+            gdk_threads_add_timeout (DAMAGE_FRAME_INTERVAL - elapsed,
+                                     hildon_remote_texture_damage_flush,
+                                     self);
+      else
+        priv->damage_flush_id =
+            gdk_threads_add_idle_full (GDK_PRIORITY_REDRAW,
+                                       hildon_remote_texture_damage_flush,
+                                       self, NULL);
     }
-  priv->set_damage = 1;
+}
 
-  if (GTK_WIDGET_MAPPED (widget) && priv->ready)
-  {
-     /* Defer messages until the remote texture is parented
-      * and the parent window is mapped */
-      if (!priv->parent || !GTK_WIDGET_MAPPED (GTK_WIDGET (priv->parent)))
-          return;
-      hildon_remote_texture_send_message (self,
-                                          damage_atom,
-                                          priv->damage_x1,
-                                          priv->damage_y1,
-                                          priv->damage_x2 - priv->damage_x1,
-                                          priv->damage_y2 - priv->damage_y1,
-                                          0);
-      priv->set_damage = 0;
-      priv->damage_x1 = 0;
-      priv->damage_y1 = 0;
-      priv->damage_x2 = 0;
-      priv->damage_y2 = 0;
-  }
+/**
+ * hildon_remote_texture_get_damage_stats:
+ * @self: A #HildonRemoteTexture
+ * @pixels_changed: return location for the number of pixels passed to
+ * hildon_remote_texture_update_area(), or %NULL
+ * @pixels_reported: return location for the number of pixels reported
+ * as damaged to the window manager, or %NULL
+ *
+ * Gets the damage counters of the remote texture, since it was created or
+ * since the last call to hildon_remote_texture_reset_damage_stats(). The
+ * difference between both numbers is the amount of pixels that are
+ * uploaded without having changed because of merged damage areas.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_remote_texture_get_damage_stats (HildonRemoteTexture *self,
+                                        guint64 *pixels_changed,
+                                        guint64 *pixels_reported)
+{
+    HildonRemoteTexturePrivate *priv;
+
+    g_return_if_fail (HILDON_IS_REMOTE_TEXTURE (self));
+
+    priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    if (pixels_changed)
+        *pixels_changed = priv->pixels_changed;
+
+    if (pixels_reported)
+        *pixels_reported = priv->pixels_reported;
+}
+
+/**
+ * hildon_remote_texture_reset_damage_stats:
+ * @self: A #HildonRemoteTexture
+ *
+ * Resets the counters returned by hildon_remote_texture_get_damage_stats().
+ *
+ * Since: 2.2
+ **/
+void
+hildon_remote_texture_reset_damage_stats (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate *priv;
+
+    g_return_if_fail (HILDON_IS_REMOTE_TEXTURE (self));
+
+    priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    priv->pixels_changed = 0;
+    priv->pixels_reported = 0;
 }
 
 /**
@@ -799,40 +1092,22 @@ hildon_remote_texture_set_scale (HildonRemoteTexture *self,
 }
 
 /*
- * This callback will be triggered by the parent widget of
- * an remote texture when it is mapped. The compositing
- * window manager is now ready to parent the remote texture
- * into the target parent window.
- */
-static gboolean
-hildon_remote_texture_parent_map_event (GtkWidget *parent,
-					 GdkEvent *event,
-					 gpointer user_data)
-{
-    hildon_remote_texture_set_parent (HILDON_REMOTE_TEXTURE (user_data),
-				       GTK_WINDOW (parent));
-    return FALSE;
-}
-
-/*
- * This callback will be triggered by the widget re-mapping
- * itself in case of WM restarting. The point is to push all
- * remote texture parameters anew to the WM.
+ * This callback will be triggered by the first map of the
+ * remote texture after a window manager restart, once the WM has
+ * created its texture actor again.
  */
 static gboolean
 hildon_remote_texture_map_event (GtkWidget *widget,
-				  GdkEvent *event,
-				  gpointer user_data)
+                                 GdkEvent *event,
+                                 gpointer user_data)
 {
     HildonRemoteTexture
 	               *self = HILDON_REMOTE_TEXTURE (user_data);
     HildonRemoteTexturePrivate
 	               *priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
 
-    hildon_remote_texture_send_all_messages (self);
-
-    /* Disconnect the "map-event" handler after the "emergency resend all
-     * actor parameters" drill is over. */
+    /* Disconnect the "map-event" handler, the resend is only needed
+     * once per restart. */
 
     if (priv->map_event_cb_id)
     {
@@ -841,6 +1116,24 @@ hildon_remote_texture_map_event (GtkWidget *widget,
 	priv->map_event_cb_id = 0;
     }
 
+    hildon_private_wm_client_queue_resend (GTK_WIDGET (self));
+
+    return FALSE;
+}
+
+/*
+ * This callback will be triggered by the parent widget of
+ * an remote texture when it is mapped. The compositing
+ * window manager is now ready to parent the remote texture
+ * into the target parent window.
+ */
+static gboolean
+hildon_remote_texture_parent_map_event (GtkWidget *parent,
+					 GdkEvent *event,
+					 gpointer user_data)
+{
+    hildon_remote_texture_set_parent (HILDON_REMOTE_TEXTURE (user_data),
+				       GTK_WINDOW (parent));
     return FALSE;
 }
 
@@ -961,3 +1254,160 @@ hildon_remote_texture_set_parent (HildonRemoteTexture *self,
     }
 }
 
+/**
+ * hildon_remote_texture_create_buffers:
+ * @self: A #HildonRemoteTexture
+ * @width: width of the image in pixels
+ * @height: height of the image in pixels
+ * @bpp: BYTES per pixel - usually 2,3 or 4
+ * @n_buffers: number of buffers, 2 or 3
+ *
+ * Creates a set of shared memory buffers owned by the remote texture,
+ * replacing any previous one. Frames are then drawn into one buffer,
+ * between hildon_remote_texture_begin_frame() and
+ * hildon_remote_texture_end_frame(), while hildon-desktop reads the one
+ * shown before. This avoids both copies and tearing.
+ *
+ * The buffers are destroyed with the remote texture.
+ *
+ * Returns: %TRUE if the buffers could be created.
+ *
+ * Since: 2.2
+ **/
+gboolean
+hildon_remote_texture_create_buffers (HildonRemoteTexture *self,
+                                      guint width,
+                                      guint height,
+                                      guint bpp,
+                                      guint n_buffers)
+{
+    HildonRemoteTexturePrivate *priv;
+    gsize size = (gsize) width * height * bpp;
+    guint i;
+
+    g_return_val_if_fail (HILDON_IS_REMOTE_TEXTURE (self), FALSE);
+    g_return_val_if_fail (n_buffers >= 2 &&
+                          n_buffers <= HILDON_REMOTE_TEXTURE_MAX_BUFFERS, FALSE);
+    g_return_val_if_fail (size > 0, FALSE);
+
+    priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    hildon_remote_texture_destroy_buffers (self);
+
+    for (i = 0; i < n_buffers; i++)
+    {
+        HildonRemoteTextureBuffer *buffer = &priv->buffers[i];
+        gint attempts;
+
+        /* hildon-desktop attaches the memory using its key, so it
+         * can't be IPC_PRIVATE. Pick unused random keys. */
+        buffer->id = -1;
+        for (attempts = 0; buffer->id == -1 && attempts < 16; attempts++)
+        {
+            buffer->key = (key_t) (g_random_int () & G_MAXINT32);
+            buffer->id = shmget (buffer->key, size, IPC_CREAT | IPC_EXCL | 0666);
+        }
+
+        if (buffer->id == -1)
+            break;
+
+        buffer->data = shmat (buffer->id, NULL, 0);
+        if (buffer->data == (gpointer) -1)
+        {
+            shmctl (buffer->id, IPC_RMID, NULL);
+            break;
+        }
+
+        priv->n_buffers++;
+    }
+
+    if (priv->n_buffers < n_buffers)
+    {
+        g_warning ("Could not create shared memory buffers for remote texture");
+        hildon_remote_texture_destroy_buffers (self);
+        return FALSE;
+    }
+
+    priv->buffer_width = width;
+    priv->buffer_height = height;
+    priv->buffer_bpp = bpp;
+    priv->back_buffer = 0;
+
+    return TRUE;
+}
+
+/**
+ * hildon_remote_texture_begin_frame:
+ * @self: A #HildonRemoteTexture
+ *
+ * Starts drawing a new frame in the back buffer created with
+ * hildon_remote_texture_create_buffers(). The buffer holds the frame
+ * shown @n_buffers frames ago, so the areas changed since then must
+ * be drawn again.
+ *
+ * Areas passed to hildon_remote_texture_update_area() until
+ * hildon_remote_texture_end_frame() are reported as the damage of the
+ * frame. If there are none, the whole frame is reported as damaged.
+ *
+ * Returns: the pixels of the back buffer, with rows of width * bpp bytes.
+ *
+ * Since: 2.2
+ **/
+guchar *
+hildon_remote_texture_begin_frame (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate *priv;
+
+    g_return_val_if_fail (HILDON_IS_REMOTE_TEXTURE (self), NULL);
+
+    priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    g_return_val_if_fail (priv->n_buffers > 0, NULL);
+    g_return_val_if_fail (!priv->in_frame, NULL);
+
+    priv->in_frame = 1;
+
+    return priv->buffers[priv->back_buffer].data;
+}
+
+/**
+ * hildon_remote_texture_end_frame:
+ * @self: A #HildonRemoteTexture
+ *
+ * Ends the frame started with hildon_remote_texture_begin_frame(). The
+ * back buffer is shown, together with its damage, in one update, and
+ * the next buffer becomes the back buffer.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_remote_texture_end_frame (HildonRemoteTexture *self)
+{
+    HildonRemoteTexturePrivate *priv;
+    HildonRemoteTextureBuffer *buffer;
+
+    g_return_if_fail (HILDON_IS_REMOTE_TEXTURE (self));
+
+    priv = HILDON_REMOTE_TEXTURE_GET_PRIVATE (self);
+
+    g_return_if_fail (priv->in_frame);
+
+    priv->in_frame = 0;
+    buffer = &priv->buffers[priv->back_buffer];
+
+    if (priv->n_damage == 0)
+        hildon_remote_texture_update_area (self, 0, 0,
+                                           priv->buffer_width,
+                                           priv->buffer_height);
+
+    hildon_remote_texture_set_image (self, buffer->key,
+                                     priv->buffer_width,
+                                     priv->buffer_height,
+                                     priv->buffer_bpp);
+
+    /* Don't wait for the next frame, the damage goes with the new image */
+    if (hildon_remote_texture_can_send_messages (self))
+        hildon_remote_texture_send_damage (self);
+
+    priv->back_buffer = (priv->back_buffer + 1) % priv->n_buffers;
+}
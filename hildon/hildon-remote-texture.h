@@ -130,6 +130,22 @@ hildon_remote_texture_set_scale (HildonRemoteTexture *self,
 void
 hildon_remote_texture_set_parent (HildonRemoteTexture *self,
 				   GtkWindow *parent);
+void
+hildon_remote_texture_get_damage_stats (HildonRemoteTexture *self,
+                                        guint64 *pixels_changed,
+                                        guint64 *pixels_reported);
+void
+hildon_remote_texture_reset_damage_stats (HildonRemoteTexture *self);
+gboolean
+hildon_remote_texture_create_buffers (HildonRemoteTexture *self,
+                                      guint width,
+                                      guint height,
+                                      guint bpp,
+                                      guint n_buffers);
+guchar *
+hildon_remote_texture_begin_frame (HildonRemoteTexture *self);
+void
+hildon_remote_texture_end_frame (HildonRemoteTexture *self);
 
 G_END_DECLS
 
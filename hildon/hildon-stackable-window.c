@@ -54,6 +54,15 @@
  * To see how to manage multiple stacks per application and for other
  * advanced details on stack handling, see #HildonWindowStack
  *
+ * Creating and realizing a new window takes a noticeable amount of
+ * time. Applications that open new windows frequently can ask
+ * #HildonStackableWindow to keep a pool of pre-created, already
+ * realized windows with hildon_stackable_window_set_pool_size(). The
+ * pool is filled when the application is idle, and windows are taken
+ * from it with hildon_stackable_window_new_from_pool(), which can be
+ * used instead of hildon_stackable_window_new() before pushing the
+ * window to a stack.
+ *
  * <example>
  * <title>Basic HildonStackableWindow example</title>
  * <programlisting>
@@ -107,6 +116,11 @@
 
 G_DEFINE_TYPE (HildonStackableWindow, hildon_stackable_window, HILDON_TYPE_WINDOW);
 
+/* Pool of pre-realized windows, see hildon_stackable_window_set_pool_size() */
+static GQueue window_pool = G_QUEUE_INIT;
+static guint window_pool_size = 0;
+static guint window_pool_idle_id = 0;
+
 void G_GNUC_INTERNAL
 hildon_stackable_window_set_stack               (HildonStackableWindow *self,
                                                  HildonWindowStack     *stack,
@@ -249,6 +263,142 @@ hildon_stackable_window_init                    (HildonStackableWindow *self)
     priv->stack_position = -1;
 }
 
+static void
+hildon_stackable_window_pool_window_destroyed   (GtkWidget *win)
+{
+    g_queue_remove (&window_pool, win);
+}
+
+static void
+hildon_stackable_window_pool_take_window        (GtkWidget *win)
+{
+    g_signal_handlers_disconnect_by_func (win, hildon_stackable_window_pool_window_destroyed, NULL);
+    g_queue_remove (&window_pool, win);
+}
+
+/* Create one window per idle iteration, so the application is never
+ * blocked for longer than it takes to create a single window */
+static gboolean
+hildon_stackable_window_pool_fill               (gpointer data)
+{
+    GtkWidget *win;
+
+    if (window_pool.length >= window_pool_size) {
+        window_pool_idle_id = 0;
+        return FALSE;
+    }
+
+    win = hildon_stackable_window_new ();
+
+    /* Realizing the window also resolves its style, creates the X
+     * window and performs the first size allocation */
+    gtk_widget_realize (win);
+
+    g_signal_connect (win, "destroy",
+                      G_CALLBACK (hildon_stackable_window_pool_window_destroyed), NULL);
+    g_queue_push_tail (&window_pool, win);
+
+    if (window_pool.length >= window_pool_size) {
+        window_pool_idle_id = 0;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void
+hildon_stackable_window_pool_schedule_fill      (void)
+{
+    if (window_pool.length < window_pool_size && window_pool_idle_id == 0) {
+        window_pool_idle_id = gdk_threads_add_idle_full (G_PRIORITY_LOW,
+                                                         hildon_stackable_window_pool_fill,
+                                                         NULL, NULL);
+    }
+}
+
+/**
+ * hildon_stackable_window_set_pool_size:
+ * @size: number of windows to keep in the pool
+ *
+ * Sets the number of pre-created #HildonStackableWindow<!-- -->s that
+ * are kept ready to be used by
+ * hildon_stackable_window_new_from_pool(). Windows are created and
+ * realized when the application is idle, so they can be pushed to a
+ * stack without any construction delay.
+ *
+ * The pool is empty by default. Setting @size to 0 destroys all
+ * windows in the pool.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_stackable_window_set_pool_size           (guint size)
+{
+    window_pool_size = size;
+
+    while (window_pool.length > window_pool_size) {
+        GtkWidget *win = g_queue_peek_tail (&window_pool);
+        hildon_stackable_window_pool_take_window (win);
+        gtk_widget_destroy (win);
+    }
+
+    if (window_pool.length >= window_pool_size && window_pool_idle_id != 0) {
+        g_source_remove (window_pool_idle_id);
+        window_pool_idle_id = 0;
+    }
+
+    hildon_stackable_window_pool_schedule_fill ();
+}
+
+/**
+ * hildon_stackable_window_get_pool_size:
+ *
+ * Returns the number of windows that are kept in the pool. See
+ * hildon_stackable_window_set_pool_size().
+ *
+ * Return value: the size of the window pool
+ *
+ * Since: 2.2
+ **/
+guint
+hildon_stackable_window_get_pool_size           (void)
+{
+    return window_pool_size;
+}
+
+/**
+ * hildon_stackable_window_new_from_pool:
+ *
+ * Returns a #HildonStackableWindow taken from the pool of
+ * pre-created windows (see hildon_stackable_window_set_pool_size()).
+ * The returned window is already realized, so it must not be used
+ * for anything that needs to be set before realization, such as
+ * changing its colormap.
+ *
+ * If the pool is empty, this function behaves like
+ * hildon_stackable_window_new(). In both cases the pool is refilled
+ * the next time the application is idle.
+ *
+ * Return value: A #HildonStackableWindow
+ *
+ * Since: 2.2
+ **/
+GtkWidget*
+hildon_stackable_window_new_from_pool           (void)
+{
+    GtkWidget *win = g_queue_peek_head (&window_pool);
+
+    if (win) {
+        hildon_stackable_window_pool_take_window (win);
+    } else {
+        win = hildon_stackable_window_new ();
+    }
+
+    hildon_stackable_window_pool_schedule_fill ();
+
+    return win;
+}
+
 /**
  * hildon_stackable_window_new:
  *
@@ -95,6 +95,15 @@ hildon_stackable_window_set_main_menu           (HildonStackableWindow *self,
 HildonWindowStack *
 hildon_stackable_window_get_stack               (HildonStackableWindow *self);
 
+void
+hildon_stackable_window_set_pool_size           (guint size);
+
+guint
+hildon_stackable_window_get_pool_size           (void);
+
+GtkWidget*
+hildon_stackable_window_new_from_pool           (void);
+
 G_END_DECLS
 
 #endif                                 /* __HILDON_STACKABLE_WINDOW_H__ */
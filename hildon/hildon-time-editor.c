@@ -748,17 +748,13 @@ void
 hildon_time_editor_get_time_separators          (GtkLabel *hm_sep_label,
                                                  GtkLabel *ms_sep_label)
 {
-    gchar buffer[256];
+    const gchar *iter, *endp = NULL;
     gchar *separator;
-    GDate locale_test_date;
-    gchar *iter, *endp = NULL;
 
     /* Get localized time string */
-    g_date_set_dmy (&locale_test_date, 1, 2, 1970);
-    (void) g_date_strftime (buffer, sizeof (buffer), "%X", &locale_test_date);
+    iter = hildon_private_get_locale_info ()->time_format;
 
     /* Find h-m separator */
-    iter = buffer;
     while (*iter && g_ascii_isdigit (*iter)) iter++;
     /* Extract h-m separator*/
     endp = iter;
@@ -1281,25 +1277,25 @@ static gboolean
 hildon_time_editor_check_locale                 (HildonTimeEditor *editor)
 {
     HildonTimeEditorPrivate *priv;
+    const HildonLocaleInfo *info;
 
     priv = HILDON_TIME_EDITOR_GET_PRIVATE (editor);
     g_assert (priv);
 
+    info = hildon_private_get_locale_info ();
+
     /* Update time separator symbols */
     hildon_time_editor_get_time_separators (GTK_LABEL (priv->hm_label), GTK_LABEL (priv->sec_label));
 
     /* Get AM/PM symbols. */
-    priv->am_symbol = g_strdup (nl_langinfo (AM_STR));
-    priv->pm_symbol = g_strdup (nl_langinfo (PM_STR));
+    priv->am_symbol = g_strdup (info->am_symbol);
+    priv->pm_symbol = g_strdup (info->pm_symbol);
 
     if (priv->am_symbol[0] == '\0')
         return TRUE;
     else {
-        /* 12h clock mode. Check if AM/PM should be before or after time.
-           %p is the AM/PM string, so we assume that if the format string
-           begins with %p it's in the beginning, and in any other case it's
-           in the end (although that's not necessarily the case). */
-        if (strncmp (nl_langinfo (T_FMT_AMPM), "%p", 2) == 0)
+        /* 12h clock mode. Check if AM/PM should be before or after time. */
+        if (info->ampm_before)
             priv->ampm_pos_after = FALSE;
         return FALSE;
     }
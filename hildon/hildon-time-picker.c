@@ -88,6 +88,7 @@
 #include                                        "hildon-defines.h"
 #include                                        "hildon-time-picker-private.h"
 #include                                        "hildon-time-editor.h"
+#include                                        "hildon-private.h"
 
 #define                                         _(String) \
                                                 dgettext("hildon-libs", String)
@@ -303,6 +304,7 @@ hildon_time_picker_init                         (HildonTimePicker *picker)
     GtkDialog *dialog = GTK_DIALOG (picker);
     GtkTable *table = NULL;
     GtkWidget *maintocenter, *colon_label;
+    const HildonLocaleInfo *info;
     const struct tm *local = NULL;
     time_t stamp;
     gint i = 0;
@@ -316,17 +318,15 @@ hildon_time_picker_init                         (HildonTimePicker *picker)
 
     /* Get AM/PM strings from locale. If they're set, the time is wanted
        in 12 hour mode. */
-    priv->am_symbol = g_strdup (nl_langinfo (AM_STR));
-    priv->pm_symbol = g_strdup (nl_langinfo (PM_STR));
+    info = hildon_private_get_locale_info ();
+    priv->am_symbol = g_strdup (info->am_symbol);
+    priv->pm_symbol = g_strdup (info->pm_symbol);
 
     priv->show_ampm = priv->am_symbol[0] != '\0';
     if (priv->show_ampm)
     {
-        /* Check if AM/PM should be before or after time.
-           %p is the AM/PM string, so we assume that if the format string
-           begins with %p it's in the beginning, and in any other case it's
-           in the end (although that's not necessarily the case). */
-        if (strncmp (nl_langinfo (T_FMT_AMPM), "%p", 2) == 0)
+        /* Check if AM/PM should be before or after time. */
+        if (info->ampm_before)
         {
             /* Before time. Update column position. */
             priv->ampm_left = TRUE;
@@ -45,11 +45,11 @@
 #include <time.h>
 #include <langinfo.h>
 #include <locale.h>
-#include <gconf/gconf-client.h>
 
 #include "hildon-enum-types.h"
 #include "hildon-time-selector.h"
 #include "hildon-touch-selector-private.h"
+#include "hildon-private.h"
 
 #define HILDON_TIME_SELECTOR_GET_PRIVATE(obj)                           \
   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), HILDON_TYPE_TIME_SELECTOR, HildonTimeSelectorPrivate))
@@ -62,11 +62,6 @@ G_DEFINE_TYPE (HildonTimeSelector, hildon_time_selector, HILDON_TYPE_TOUCH_SELEC
 #define _(String)  dgettext("hildon-libs", String)
 #define N_(String) String
 
-
-/* FIXME: we should get this two props from the clock ui headers */
-#define CLOCK_GCONF_PATH "/apps/clock"
-#define CLOCK_GCONF_IS_24H_FORMAT CLOCK_GCONF_PATH  "/time-format"
-
 enum {
   COLUMN_STRING,
   COLUMN_INT,
@@ -496,22 +491,7 @@ _manage_ampm_selection_cb (HildonTouchSelector * touch_selector,
 static void
 check_automatic_ampm_format (HildonTimeSelector * selector)
 {
-  GConfClient *client = NULL;
-  gboolean value = TRUE;
-  GError *error = NULL;
-
-  client = gconf_client_get_default ();
-  value = gconf_client_get_bool (client, CLOCK_GCONF_IS_24H_FORMAT, &error);
-  if (error != NULL) {
-    g_warning
-      ("Error trying to get gconf variable %s, using 24h format by default",
-       CLOCK_GCONF_IS_24H_FORMAT);
-    g_error_free (error);
-  }
-
-  g_object_unref (client);
-
-  selector->priv->ampm_format = !value;
+  selector->priv->ampm_format = !hildon_private_get_clock_24h ();
 }
 
 static void
@@ -33,6 +33,15 @@ G_BEGIN_DECLS
 
 typedef struct                                  _HildonWindowPrivate HildonWindowPrivate;
 
+typedef struct                                  _HildonWindowChromeBox HildonWindowChromeBox;
+
+/* A themed box drawn around the window contents (borders, toolbars) */
+struct                                          _HildonWindowChromeBox
+{
+    const gchar *detail;
+    GdkRectangle area;
+};
+
 struct                                          _HildonWindowPrivate
 {
     GtkMenu *menu;
@@ -43,6 +52,10 @@ struct                                          _HildonWindowPrivate
     GtkBorder *borders;
     GtkBorder *toolbar_borders;
 
+    /* Array of HildonWindowChromeBox, in painting order */
+    GArray *chrome;
+    guint chrome_dirty : 1;
+
     GtkAllocation allocation;
 
     gchar *markup;
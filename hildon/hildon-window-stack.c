@@ -50,6 +50,13 @@
  * several windows at the same time in a single step. See
  * hildon_window_stack_push(), hildon_window_stack_pop() and
  * hildon_window_stack_pop_and_push() for more details.
+ *
+ * Arbitrary sequences of those operations can also be grouped in a
+ * single step by calling them between
+ * hildon_window_stack_begin_transaction() and
+ * hildon_window_stack_commit_transaction(). Windows are only shown
+ * and hidden when the transaction is committed, so intermediate
+ * states are never seen by the user.
  */
 
 #include                                        "hildon-window-stack.h"
@@ -58,9 +65,16 @@
 
 struct                                          _HildonWindowStackPrivate
 {
-    GList *list;
+    GPtrArray *windows; /* Stacked windows, bottommost first */
     GtkWindowGroup *group;
     GdkWindow *leader; /* X Window group hint for all windows in a group */
+
+    /* Pending transaction */
+    gint transaction_depth;
+    GtkWidget *old_top;
+    gint old_top_position;
+    GList *pushed; /* Windows pushed during the transaction, topmost first */
+    GList *removed; /* Windows removed during the transaction, bottommost first */
 };
 
 #define                                         HILDON_WINDOW_STACK_GET_PRIVATE(obj) \
@@ -150,7 +164,7 @@ hildon_window_stack_size                        (HildonWindowStack *stack)
 {
     g_return_val_if_fail (HILDON_IS_WINDOW_STACK (stack), 0);
 
-    return g_list_length (stack->priv->list);
+    return stack->priv->windows->len;
 }
 
 static GdkWindow *
@@ -199,7 +213,8 @@ hildon_window_stack_remove                      (HildonStackableWindow *win)
 
     /* If the window is stacked */
     if (stack) {
-        GList *pos;
+        GPtrArray *windows = stack->priv->windows;
+        gint pos;
 
         hildon_stackable_window_set_stack (win, NULL, -1);
         gtk_window_set_transient_for (GTK_WINDOW (win), NULL);
@@ -207,17 +222,26 @@ hildon_window_stack_remove                      (HildonStackableWindow *win)
             gdk_window_set_group (GTK_WIDGET (win)->window, NULL);
         }
 
+        /* Windows are usually removed from the top, so start there */
+        for (pos = (gint) windows->len - 1; pos >= 0; pos--) {
+            if (g_ptr_array_index (windows, pos) == win)
+                break;
+        }
+        g_assert (pos >= 0);
+
         /* If the window removed is in the middle of the stack, update
          * transiency of other windows */
-        pos = g_list_find (stack->priv->list, win);
-        g_assert (pos != NULL);
-        if (pos->prev) {
-            GtkWindow *upper = GTK_WINDOW (pos->prev->data);
-            GtkWindow *lower = pos->next ? GTK_WINDOW (pos->next->data) : NULL;
+        if (pos < (gint) windows->len - 1) {
+            GtkWindow *upper = GTK_WINDOW (g_ptr_array_index (windows, pos + 1));
+            GtkWindow *lower = pos > 0 ? GTK_WINDOW (g_ptr_array_index (windows, pos - 1)) : NULL;
             gtk_window_set_transient_for (upper, lower);
         }
 
-        stack->priv->list = g_list_remove (stack->priv->list, win);
+        g_ptr_array_remove_index (windows, pos);
+
+        if (stack->priv->transaction_depth > 0) {
+            stack->priv->removed = g_list_prepend (stack->priv->removed, g_object_ref (win));
+        }
 
         g_signal_handlers_disconnect_by_func (win, hildon_window_stack_window_realized, stack);
     }
@@ -238,9 +262,16 @@ hildon_window_stack_remove                      (HildonStackableWindow *win)
 GList *
 hildon_window_stack_get_windows                 (HildonWindowStack *stack)
 {
+    GList *list = NULL;
+    guint i;
+
     g_return_val_if_fail (HILDON_IS_WINDOW_STACK (stack), NULL);
 
-    return g_list_copy (stack->priv->list);
+    for (i = 0; i < stack->priv->windows->len; i++) {
+        list = g_list_prepend (list, g_ptr_array_index (stack->priv->windows, i));
+    }
+
+    return list;
 }
 
 /**
@@ -261,8 +292,9 @@ hildon_window_stack_peek                        (HildonWindowStack *stack)
 
     g_return_val_if_fail (HILDON_IS_WINDOW_STACK (stack), NULL);
 
-    if (stack->priv->list != NULL) {
-        win = GTK_WIDGET (stack->priv->list->data);
+    if (stack->priv->windows->len > 0) {
+        win = GTK_WIDGET (g_ptr_array_index (stack->priv->windows,
+                                             stack->priv->windows->len - 1));
     }
 
     return win;
@@ -293,7 +325,11 @@ _hildon_window_stack_do_push                    (HildonWindowStack     *stack,
 
         /* Push the window */
         hildon_stackable_window_set_stack (win, stack, pos);
-        stack->priv->list = g_list_prepend (stack->priv->list, win);
+        g_ptr_array_add (stack->priv->windows, win);
+
+        if (stack->priv->transaction_depth > 0) {
+            stack->priv->pushed = g_list_prepend (stack->priv->pushed, g_object_ref (win));
+        }
 
         /* Make the window part of the same group as its parent */
         if (parent) {
@@ -329,6 +365,138 @@ _hildon_window_stack_do_pop                     (HildonWindowStack *stack)
     return win;
 }
 
+/**
+ * hildon_window_stack_begin_transaction:
+ * @stack: A %HildonWindowStack
+ *
+ * Starts a transaction on @stack. All windows pushed to or popped
+ * from @stack until hildon_window_stack_commit_transaction() is
+ * called are not shown or hidden immediately. Instead, all the
+ * resulting changes are sent to the window manager when the
+ * transaction is committed, so the user will only see the final
+ * state of the stack.
+ *
+ * Transactions can be nested. Changes are only applied when the
+ * outermost transaction is committed.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_window_stack_begin_transaction           (HildonWindowStack *stack)
+{
+    HildonWindowStackPrivate *priv;
+
+    g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
+
+    priv = stack->priv;
+
+    if (priv->transaction_depth++ == 0) {
+        priv->old_top = hildon_window_stack_peek (stack);
+        priv->old_top_position = priv->old_top ?
+            HILDON_STACKABLE_WINDOW_GET_PRIVATE (priv->old_top)->stack_position : -1;
+    }
+}
+
+/* Hide a window that has been popped and pushed back during a
+ * transaction, without removing it from the stack. This way all
+ * windows with a changed stack index will be unmapped and mapped
+ * again. */
+static void
+hildon_window_stack_rehide_window               (HildonWindowStack     *stack,
+                                                 HildonStackableWindow *win)
+{
+    HildonStackableWindowPrivate *priv = HILDON_STACKABLE_WINDOW_GET_PRIVATE (win);
+
+    priv->stack = NULL;
+    gtk_widget_hide (GTK_WIDGET (win));
+    priv->stack = stack;
+}
+
+/**
+ * hildon_window_stack_commit_transaction:
+ * @stack: A %HildonWindowStack
+ *
+ * Commits a transaction started with
+ * hildon_window_stack_begin_transaction(). Windows pushed during the
+ * transaction are shown, and windows popped are hidden, in a single
+ * transition.
+ *
+ * Since: 2.2
+ **/
+void
+hildon_window_stack_commit_transaction          (HildonWindowStack *stack)
+{
+    HildonWindowStackPrivate *priv;
+    GtkWidget *top;
+    GList *l;
+    gboolean need_flush = FALSE;
+
+    g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
+    g_return_if_fail (stack->priv->transaction_depth > 0);
+
+    priv = stack->priv;
+
+    if (--priv->transaction_depth > 0)
+        return;
+
+    /*
+     * We need to call gdk_flush() because the application that called us might
+     * just shown some of the windows we manipulate, and if the GTK+ has not
+     * processed the MapNotify yet it will end up calling the XWithdrawWindow
+     * when we hide the window (and will actually not unmap it).
+     * This is only needed if there's any mapped window to hide, and
+     * only once per transaction.
+     */
+    for (l = priv->removed; l != NULL && !need_flush; l = l->next) {
+        need_flush = GTK_WIDGET_MAPPED (l->data);
+    }
+    if (need_flush)
+        gdk_flush ();
+
+    /* Hide now windows that are popped and then pushed back */
+    for (l = priv->removed; l != NULL; l = l->next) {
+        HildonStackableWindow *win = HILDON_STACKABLE_WINDOW (l->data);
+        if (hildon_stackable_window_get_stack (win) == stack) {
+            hildon_window_stack_rehide_window (stack, win);
+        }
+    }
+
+    /* The WM will be confused if the old topmost window and the new
+     * one have the same index, so make sure that they're different */
+    top = hildon_window_stack_peek (stack);
+    if (top && top != priv->old_top) {
+        HildonStackableWindowPrivate *top_priv = HILDON_STACKABLE_WINDOW_GET_PRIVATE (top);
+        if (top_priv->stack_position == priv->old_top_position) {
+            top_priv->stack_position++;
+        }
+    }
+
+    /* Show windows in reverse order (topmost first) */
+    for (l = priv->pushed; l != NULL; l = l->next) {
+        if (hildon_stackable_window_get_stack (l->data) == stack) {
+            gtk_widget_show (GTK_WIDGET (l->data));
+        }
+    }
+
+    /* Hide windows that are popped but not pushed back (topmost last) */
+    for (l = priv->removed; l != NULL; l = l->next) {
+        if (hildon_stackable_window_get_stack (l->data) == NULL) {
+            gtk_widget_hide (GTK_WIDGET (l->data));
+        }
+    }
+
+    g_list_foreach (priv->pushed, (GFunc) g_object_unref, NULL);
+    g_list_free (priv->pushed);
+    priv->pushed = NULL;
+
+    g_list_foreach (priv->removed, (GFunc) g_object_unref, NULL);
+    g_list_free (priv->removed);
+    priv->removed = NULL;
+
+    priv->old_top = NULL;
+    priv->old_top_position = -1;
+}
+
 /**
  * hildon_window_stack_push_1:
  * @stack: A %HildonWindowStack
@@ -343,8 +511,11 @@ void
 hildon_window_stack_push_1                      (HildonWindowStack     *stack,
                                                  HildonStackableWindow *win)
 {
-    if (_hildon_window_stack_do_push (stack, win))
-        gtk_widget_show (GTK_WIDGET (win));
+    g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
+
+    hildon_window_stack_begin_transaction (stack);
+    _hildon_window_stack_do_push (stack, win);
+    hildon_window_stack_commit_transaction (stack);
 }
 
 /**
@@ -362,9 +533,14 @@ hildon_window_stack_push_1                      (HildonWindowStack     *stack,
 GtkWidget *
 hildon_window_stack_pop_1                       (HildonWindowStack *stack)
 {
-    GtkWidget *win = _hildon_window_stack_do_pop (stack);
-    if (win)
-        gtk_widget_hide (win);
+    GtkWidget *win;
+
+    g_return_val_if_fail (HILDON_IS_WINDOW_STACK (stack), NULL);
+
+    hildon_window_stack_begin_transaction (stack);
+    win = _hildon_window_stack_do_pop (stack);
+    hildon_window_stack_commit_transaction (stack);
+
     return win;
 }
 
@@ -384,27 +560,23 @@ void
 hildon_window_stack_push_list                   (HildonWindowStack *stack,
                                                  GList             *list)
 {
-    HildonStackableWindow *win;
     GList *l;
-    GList *pushed = NULL;
 
     g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
 
+    hildon_window_stack_begin_transaction (stack);
+
     /* Stack all windows */
     for (l = list; l != NULL; l = g_list_next (l)) {
-        win = HILDON_STACKABLE_WINDOW (l->data);
+        HildonStackableWindow *win = HILDON_STACKABLE_WINDOW (l->data);
         if (win) {
             _hildon_window_stack_do_push (stack, win);
-            pushed = g_list_prepend (pushed, win);
         } else {
             g_warning ("Trying to stack a non-stackable window!");
         }
     }
 
-    /* Show windows in reverse order (topmost first) */
-    g_list_foreach (pushed, (GFunc) gtk_widget_show, NULL);
-
-    g_list_free (pushed);
+    hildon_window_stack_commit_transaction (stack);
 }
 
 /**
@@ -469,7 +641,9 @@ hildon_window_stack_pop                         (HildonWindowStack  *stack,
 
     g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
     g_return_if_fail (nwindows > 0);
-    g_return_if_fail (g_list_length (stack->priv->list) >= nwindows);
+    g_return_if_fail (hildon_window_stack_size (stack) >= nwindows);
+
+    hildon_window_stack_begin_transaction (stack);
 
     /* Pop windows */
     for (i = 0; i < nwindows; i++) {
@@ -477,8 +651,7 @@ hildon_window_stack_pop                         (HildonWindowStack  *stack,
         popped = g_list_prepend (popped, win);
     }
 
-    /* Hide windows in reverse order (topmost last) */
-    g_list_foreach (popped, (GFunc) gtk_widget_hide, NULL);
+    hildon_window_stack_commit_transaction (stack);
 
     if (popped_windows) {
         *popped_windows = popped;
@@ -511,38 +684,20 @@ hildon_window_stack_pop_and_push_list           (HildonWindowStack  *stack,
                                                  GList             **popped_windows,
                                                  GList              *list)
 {
-    gint i, topmost_index;
+    gint i;
     GList *l;
     GList *popped = NULL;
-    GList *pushed = NULL;
-    HildonStackableWindowPrivate *priv;
 
     g_return_if_fail (HILDON_IS_WINDOW_STACK (stack));
     g_return_if_fail (nwindows > 0);
-    g_return_if_fail (g_list_length (stack->priv->list) >= nwindows);
+    g_return_if_fail (hildon_window_stack_size (stack) >= nwindows);
 
-    /*
-     * We need to call gdk_flush() because the application that called us might
-     * just shown some of the windows we manipulate, and if the GTK+ has not
-     * processed the MapNotify yet it will end up calling the XWithdrawWindow
-     * when we hide the window (and will actually not unmap it).
-     */
-    gdk_flush ();
-
-    /* Store the index of the topmost window */
-    priv = HILDON_STACKABLE_WINDOW_GET_PRIVATE (hildon_window_stack_peek (stack));
-    topmost_index = priv->stack_position;
+    hildon_window_stack_begin_transaction (stack);
 
     /* Pop windows */
     for (i = 0; i < nwindows; i++) {
         GtkWidget *win = _hildon_window_stack_do_pop (stack);
         popped = g_list_prepend (popped, win);
-        /* Hide now windows that are popped and then pushed back.
-           This way all the windows that has a changed stack index
-           will be unmapped and mapped again. */
-        if (g_list_find (list, win) != NULL) {
-            gtk_widget_hide (win);
-        }
     }
 
     /* Push windows */
@@ -550,32 +705,13 @@ hildon_window_stack_pop_and_push_list           (HildonWindowStack  *stack,
         HildonStackableWindow *win = HILDON_STACKABLE_WINDOW (l->data);
         if (win) {
             _hildon_window_stack_do_push (stack, win);
-            pushed = g_list_prepend (pushed, win);
         } else {
             g_warning ("Trying to stack a non-stackable window!");
         }
     }
 
-    if (pushed != NULL) {
-        /* The WM will be confused if the old topmost window and the new
-         * one have the same index, so make sure that they're different */
-        priv = HILDON_STACKABLE_WINDOW_GET_PRIVATE (hildon_window_stack_peek (stack));
-        if (priv->stack_position == topmost_index) {
-            priv->stack_position++;
-        }
-    }
-
-    /* Show windows in reverse order (topmost first) */
-    g_list_foreach (pushed, (GFunc) gtk_widget_show, NULL);
+    hildon_window_stack_commit_transaction (stack);
 
-    /* Hide windows that are popped but not pushed back (topmost last) */
-    for (l = popped; l != NULL; l = l->next) {
-        if (g_list_find (list, l->data) == NULL) {
-            gtk_widget_hide (GTK_WIDGET (l->data));
-        }
-    }
-
-    g_list_free (pushed);
     if (popped_windows) {
         *popped_windows = popped;
     } else {
@@ -633,9 +769,11 @@ hildon_window_stack_finalize (GObject *object)
 {
     HildonWindowStack *stack = HILDON_WINDOW_STACK (object);
 
-    if (stack->priv->list)
+    if (stack->priv->windows->len > 0)
         hildon_window_stack_pop (stack, hildon_window_stack_size (stack), NULL);
 
+    g_ptr_array_free (stack->priv->windows, TRUE);
+
     if (stack->priv->group)
         g_object_unref (stack->priv->group);
 
@@ -714,6 +852,11 @@ hildon_window_stack_init (HildonWindowStack *self)
 
     priv = self->priv = HILDON_WINDOW_STACK_GET_PRIVATE (self);
 
-    priv->list = NULL;
+    priv->windows = g_ptr_array_new ();
     priv->group = NULL;
+    priv->transaction_depth = 0;
+    priv->old_top = NULL;
+    priv->old_top_position = -1;
+    priv->pushed = NULL;
+    priv->removed = NULL;
 }
@@ -132,6 +132,12 @@ hildon_window_stack_pop_and_push_list           (HildonWindowStack  *stack,
                                                  GList             **popped_windows,
                                                  GList              *list);
 
+void
+hildon_window_stack_begin_transaction           (HildonWindowStack *stack);
+
+void
+hildon_window_stack_commit_transaction          (HildonWindowStack *stack);
+
 G_END_DECLS
 
 #endif                                          /* __HILDON_WINDOW_STACK_H__ */
@@ -228,20 +228,11 @@ static void
 hildon_window_get_borders                       (HildonWindow *window);
 
 static void
-visible_toolbar                                 (gpointer data, 
-                                                 gpointer user_data);
+hildon_window_style_set                         (GtkWidget *widget,
+                                                 GtkStyle  *previous_style);
 
 static void
-paint_toolbar                                   (GtkWidget *widget, 
-                                                 GtkBox *box, 
-                                                 GdkEventExpose * event, 
-                                                 gboolean fullscreen);
-
-static void
-paint_edit_toolbar                              (GtkWidget *widget,
-                                                 GtkWidget *toolbar,
-                                                 GdkEventExpose *event,
-                                                 gboolean fullscreen);
+hildon_window_update_chrome                     (HildonWindow *window);
 
 enum
 {
@@ -273,6 +264,7 @@ hildon_window_class_init                        (HildonWindowClass * window_clas
     widget_class->size_allocate         = hildon_window_size_allocate;
     widget_class->size_request          = hildon_window_size_request;
     widget_class->expose_event          = hildon_window_expose;
+    widget_class->style_set             = hildon_window_style_set;
     widget_class->show_all              = hildon_window_show_all;
     widget_class->realize               = hildon_window_realize;
     widget_class->unrealize             = hildon_window_unrealize;
@@ -354,6 +346,8 @@ hildon_window_init                              (HildonWindow *self)
     priv->is_topmost = FALSE;
     priv->borders = NULL;
     priv->toolbar_borders = NULL;
+    priv->chrome = g_array_new (FALSE, FALSE, sizeof (HildonWindowChromeBox));
+    priv->chrome_dirty = TRUE;
     priv->escape_timeout = 0;
     priv->markup = NULL;
 
@@ -385,6 +379,8 @@ hildon_window_finalize                          (GObject * obj_self)
     if (priv->toolbar_borders)
         gtk_border_free (priv->toolbar_borders);
 
+    g_array_free (priv->chrome, TRUE);
+
     if (G_OBJECT_CLASS (hildon_window_parent_class)->finalize)
         G_OBJECT_CLASS (hildon_window_parent_class)->finalize (obj_self);
 
@@ -584,34 +580,109 @@ hildon_window_get_borders                       (HildonWindow *window)
         priv->toolbar_borders = g_boxed_copy (GTK_TYPE_BORDER, &zero);
 }
 
-static gboolean
-hildon_window_expose                            (GtkWidget *widget, 
-                                                 GdkEventExpose * event)
+static void
+hildon_window_style_set                         (GtkWidget *widget,
+                                                 GtkStyle  *previous_style)
 {
     HildonWindowPrivate *priv = HILDON_WINDOW_GET_PRIVATE (widget);
     g_assert (priv);
 
-    GtkWidget *bx = priv->vbox;
-    GtkBox *box = GTK_BOX(bx);
-    GtkBorder *b = priv->borders;
-    GtkBorder *tb = priv->toolbar_borders;
-    gint tb_height = 0;
+    if (GTK_WIDGET_CLASS (hildon_window_parent_class)->style_set)
+        GTK_WIDGET_CLASS (hildon_window_parent_class)->style_set (widget, previous_style);
 
-    if (! priv->borders) {
-        hildon_window_get_borders (HILDON_WINDOW (widget));
-        b = priv->borders;
-        tb = priv->toolbar_borders;
+    /* The border sizes come from the style, so fetch them again */
+    if (priv->borders) {
+        gtk_border_free (priv->borders);
+        priv->borders = NULL;
+    }
+
+    if (priv->toolbar_borders) {
+        gtk_border_free (priv->toolbar_borders);
+        priv->toolbar_borders = NULL;
     }
 
+    priv->chrome_dirty = TRUE;
+}
+
+static void
+add_chrome_box                                  (GArray *chrome,
+                                                 const gchar *detail,
+                                                 gint x,
+                                                 gint y,
+                                                 gint width,
+                                                 gint height)
+{
+    HildonWindowChromeBox box;
+
+    box.detail = detail;
+    box.area.x = x;
+    box.area.y = y;
+    box.area.width = width;
+    box.area.height = height;
+
+    g_array_append_val (chrome, box);
+}
+
+/*
+ * Compute the position of all the boxes painted around the window
+ * contents. This only needs to be done when the style, the size, the
+ * fullscreen state or the visible toolbars change, not on every
+ * expose.
+ */
+static void
+hildon_window_update_chrome                     (HildonWindow *window)
+{
+    HildonWindowPrivate *priv = HILDON_WINDOW_GET_PRIVATE (window);
+    GtkWidget *widget = GTK_WIDGET (window);
+    GtkWidget *bx = priv->vbox;
+    GtkBorder *b, *tb;
+    GList *l;
+    gint toolbar_num = 0;
+    gint tb_height;
+    gint count;
+
+    g_assert (priv);
+
+    if (! priv->borders)
+        hildon_window_get_borders (window);
+
+    b = priv->borders;
+    tb = priv->toolbar_borders;
+
+    g_array_set_size (priv->chrome, 0);
+
     tb_height = bx->allocation.height + tb->top + tb->bottom;
 
-    paint_toolbar (widget, box,
-            event, priv->fullscreen);
+    /* collect info to help on painting the boxes */
+    for (l = GTK_BOX (bx)->children; l != NULL; l = l->next) {
+        if (GTK_WIDGET_VISIBLE (((GtkBoxChild *) l->data)->widget))
+            toolbar_num++;
+    }
 
-    if (priv->edit_toolbar != NULL)
-    {
-        paint_edit_toolbar (widget, priv->edit_toolbar,
-                            event, priv->fullscreen);
+    if (toolbar_num > 0) {
+        /*top most toolbar painting*/
+        add_chrome_box (priv->chrome, "toolbar-primary",
+                        widget->allocation.x,
+                        bx->allocation.y,
+                        widget->allocation.width,
+                        TOOLBAR_HEIGHT);
+
+        /*multi toolbar painting*/
+        for (count = 0; count < toolbar_num - 1; count++) {
+            add_chrome_box (priv->chrome, "toolbar-secondary",
+                            widget->allocation.x,
+                            bx->allocation.y + (1 + count) * (TOOLBAR_HEIGHT),
+                            widget->allocation.width,
+                            TOOLBAR_HEIGHT);
+        }
+    }
+
+    if (priv->edit_toolbar != NULL && GTK_WIDGET_VISIBLE (priv->edit_toolbar)) {
+        add_chrome_box (priv->chrome, "toolbar-edit-mode",
+                        priv->edit_toolbar->allocation.x,
+                        priv->edit_toolbar->allocation.y,
+                        priv->edit_toolbar->allocation.width,
+                        priv->edit_toolbar->allocation.height);
     }
 
     if (! priv->fullscreen) {
@@ -624,47 +695,66 @@ hildon_window_expose                            (GtkWidget *widget,
         else
             side_borders_height -= b->bottom;
 
-        if (b->left > 0) 
-        {
-            gtk_paint_box (widget->style, widget->window,
-                    GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-                    &event->area, widget, "left-border",
-                    widget->allocation.x, widget->allocation.y +
-                    b->top, b->left, side_borders_height);
-        } 
-
-        if (b->right > 0)
-        {
-            gtk_paint_box (widget->style, widget->window,
-                    GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-                    &event->area, widget, "right-border",
-                    widget->allocation.x + widget->allocation.width -
-                    b->right, widget->allocation.y + b->top,
-                    b->right, side_borders_height);
+        if (b->left > 0) {
+            add_chrome_box (priv->chrome, "left-border",
+                            widget->allocation.x, widget->allocation.y + b->top,
+                            b->left, side_borders_height);
+        }
+
+        if (b->right > 0) {
+            add_chrome_box (priv->chrome, "right-border",
+                            widget->allocation.x + widget->allocation.width - b->right,
+                            widget->allocation.y + b->top,
+                            b->right, side_borders_height);
         }
 
         /* If no toolbar, draw the bottom window border */
-        if (! priv->visible_toolbars && b->bottom > 0)
-        {
-            gtk_paint_box (widget->style, widget->window,
-                    GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-                    &event->area, widget, "bottom-border",
-                    widget->allocation.x, widget->allocation.y +
-                    (widget->allocation.height - b->bottom),
-                    widget->allocation.width, b->bottom);
+        if (! priv->visible_toolbars && b->bottom > 0) {
+            add_chrome_box (priv->chrome, "bottom-border",
+                            widget->allocation.x,
+                            widget->allocation.y + (widget->allocation.height - b->bottom),
+                            widget->allocation.width, b->bottom);
         }
 
         /* Draw the top border */
-        if (b->top > 0)
-        {
-            gtk_paint_box (widget->style, widget->window,
-                    GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-                    &event->area, widget, "top-border",
-                    widget->allocation.x, widget->allocation.y,
-                    widget->allocation.width, b->top);
-        } 
+        if (b->top > 0) {
+            add_chrome_box (priv->chrome, "top-border",
+                            widget->allocation.x, widget->allocation.y,
+                            widget->allocation.width, b->top);
+        }
+    }
+
+    priv->chrome_dirty = FALSE;
+}
+
+static gboolean
+hildon_window_expose                            (GtkWidget *widget, 
+                                                 GdkEventExpose * event)
+{
+    HildonWindowPrivate *priv = HILDON_WINDOW_GET_PRIVATE (widget);
+    guint i;
+
+    g_assert (priv);
+
+    if (priv->chrome_dirty)
+        hildon_window_update_chrome (HILDON_WINDOW (widget));
 
+    /* Only paint the boxes that intersect the exposed region, so
+     * exposes inside the window contents don't repaint the chrome */
+    for (i = 0; i < priv->chrome->len; i++) {
+        HildonWindowChromeBox *box = &g_array_index (priv->chrome, HildonWindowChromeBox, i);
+        GdkRectangle clip;
 
+        if (gdk_region_rect_in (event->region, &box->area) == GDK_OVERLAP_RECTANGLE_OUT)
+            continue;
+
+        gdk_rectangle_intersect (&event->area, &box->area, &clip);
+
+        gtk_paint_box (widget->style, widget->window,
+                       GTK_WIDGET_STATE (widget), GTK_SHADOW_OUT,
+                       &clip, widget, box->detail,
+                       box->area.x, box->area.y,
+                       box->area.width, box->area.height);
     }
 
     /* don't draw the window stuff as it overwrites our borders with a blank
@@ -728,6 +818,7 @@ hildon_window_size_allocate                     (GtkWidget *widget,
     tb = priv->toolbar_borders;
 
     widget->allocation = *allocation;
+    priv->chrome_dirty = TRUE;
 
     /* Calculate allocation of edit toolbar */
     if (priv->edit_toolbar != NULL && GTK_WIDGET_VISIBLE (priv->edit_toolbar))
@@ -941,71 +1032,6 @@ hildon_window_notify                            (GObject *gobject,
 }
 
 
-static void
-visible_toolbar                                 (gpointer data, 
-                                                 gpointer user_data)
-{
-    if (GTK_WIDGET_VISIBLE (((GtkBoxChild *)data)->widget))
-        (*((gint *)user_data))++;
-}
-
-static void
-paint_toolbar                                   (GtkWidget *widget, 
-                                                 GtkBox *box, 
-                                                 GdkEventExpose * event, 
-                                                 gboolean fullscreen)
-{
-    gint toolbar_num = 0; 
-    gint count;
-
-    /* collect info to help on painting the boxes */
-    g_list_foreach (box->children, visible_toolbar, 
-            (gpointer) &toolbar_num);
-
-    if(toolbar_num <= 0)
-        return;
-
-    /*top most toolbar painting*/
-    gtk_paint_box (widget->style, widget->window,
-            GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-            &event->area, widget, "toolbar-primary",
-            widget->allocation.x,
-            GTK_WIDGET(box)->allocation.y,
-            widget->allocation.width,
-            TOOLBAR_HEIGHT);
-
-    /*multi toolbar painting*/
-    for (count = 0; count < toolbar_num - 1; count++)
-    {
-            gtk_paint_box (widget->style, widget->window,
-                           GTK_WIDGET_STATE(widget), GTK_SHADOW_OUT,
-                           &event->area, widget, "toolbar-secondary",
-                           widget->allocation.x,
-                           GTK_WIDGET(box)->allocation.y +
-                           (1 + count) * (TOOLBAR_HEIGHT),
-                           widget->allocation.width,
-                           TOOLBAR_HEIGHT);
-    }
-}
-
-static void
-paint_edit_toolbar                              (GtkWidget *widget,
-                                                 GtkWidget *toolbar,
-                                                 GdkEventExpose *event,
-                                                 gboolean fullscreen)
-{
-    if (!GTK_WIDGET_VISIBLE (toolbar))
-        return;
-
-    gtk_paint_box (widget->style, widget->window,
-                   GTK_WIDGET_STATE (widget), GTK_SHADOW_OUT,
-                   &event->area, widget, "toolbar-edit-mode",
-                   toolbar->allocation.x,
-                   toolbar->allocation.y,
-                   toolbar->allocation.width,
-                   toolbar->allocation.height);
-}
-
 /*
  * Checks the root window to know which is the topped window
  */
@@ -1185,8 +1211,10 @@ hildon_window_window_state_event                (GtkWidget *widget,
     HildonWindowPrivate *priv = HILDON_WINDOW_GET_PRIVATE (widget);
     g_assert (priv != NULL);
 
-    if (event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN)
+    if (event->changed_mask & GDK_WINDOW_STATE_FULLSCREEN) {
         priv->fullscreen = event->new_window_state & GDK_WINDOW_STATE_FULLSCREEN;
+        priv->chrome_dirty = TRUE;
+    }
 
     if (GTK_WIDGET_CLASS (hildon_window_parent_class)->window_state_event)
     {
@@ -1782,6 +1810,8 @@ toolbar_visible_notify                          (GtkWidget *toolbar, GParamSpec
     gtk_widget_hide (priv->vbox);
   else
     gtk_widget_show (priv->vbox);
+
+  priv->chrome_dirty = TRUE;
 }
 
 /**
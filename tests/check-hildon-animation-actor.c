@@ -0,0 +1,336 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include <gtk/gtkmain.h>
+#include "test_suites.h"
+#include "check_utils.h"
+#include "fake_wm.h"
+#include <hildon/hildon.h>
+
+static HildonAnimationActor *actor = NULL;
+
+/* Returns the last message of @type recorded by the fake WM, or NULL */
+static FakeWMMessage *
+last_message (const gchar *type)
+{
+    GArray *messages = fake_wm_get_messages ();
+    FakeWMMessage *last = NULL;
+    guint i;
+
+    for (i = 0; i < messages->len; i++)
+    {
+        FakeWMMessage *message = &g_array_index (messages, FakeWMMessage, i);
+
+        if (strcmp (message->type, type) == 0)
+            last = message;
+    }
+
+    return last;
+}
+
+/* -------------------- Fixtures -------------------- */
+
+static void
+fx_setup_managed_animation_actor ()
+{
+    int argc = 0;
+
+    gtk_init (&argc, NULL);
+
+    fail_if (!fake_wm_start (),
+             "hildon-animation-actor: could not start the fake WM");
+
+    actor = HILDON_ANIMATION_ACTOR (hildon_animation_actor_new ());
+    show_test_window (GTK_WIDGET (actor));
+
+    fake_wm_manage (GTK_WIDGET (actor), "_HILDON_ANIMATION_CLIENT_READY");
+    fake_wm_clear_messages ();
+}
+
+static void
+fx_teardown_managed_animation_actor ()
+{
+    gtk_widget_destroy (GTK_WIDGET (actor));
+    fake_wm_stop ();
+}
+
+/* ----- Test case for begin_update/commit_update -----*/
+
+/**
+ * Purpose: Check that changes grouped in an update are sent once, with
+ *          their latest values.
+ */
+START_TEST (test_update_coalescing)
+{
+    FakeWMMessage *last;
+
+    hildon_animation_actor_begin_update (actor);
+    hildon_animation_actor_set_position (actor, 10, 20);
+    hildon_animation_actor_set_position (actor, 30, 40);
+    hildon_animation_actor_set_depth (actor, 5);
+
+    fake_wm_process_events ();
+
+    fail_if (fake_wm_get_messages ()->len != 0,
+             "hildon-animation-actor: messages sent during an update");
+
+    hildon_animation_actor_commit_update (actor);
+
+    fake_wm_process_events ();
+
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION") != 1,
+             "hildon-animation-actor: position not sent exactly once");
+    last = last_message ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION");
+    fail_if (last->data[0] != 30 || last->data[1] != 40 || last->data[2] != 5,
+             "hildon-animation-actor: wrong position sent on commit");
+}
+END_TEST
+
+/* ----- Test case for keyframe timelines -----*/
+
+static void
+timeline_completed (HildonAnimationActor *self,
+                    gpointer user_data)
+{
+    *((gboolean *) user_data) = TRUE;
+}
+
+static gboolean
+timeline_timeout (gpointer user_data)
+{
+    *((gboolean *) user_data) = TRUE;
+    return FALSE;
+}
+
+/**
+ * Purpose: Check that a timeline ends at the value of its last keyframe,
+ *          and only sends the attributes that change.
+ */
+START_TEST (test_timeline_keyframes)
+{
+    FakeWMMessage *last;
+    gboolean completed = FALSE;
+    gboolean timed_out = FALSE;
+    guint timeout_id;
+
+    hildon_animation_actor_add_keyframe (actor, HILDON_AA_ATTR_X,
+                                         100, 200, HILDON_AA_EASE_IN_OUT);
+    hildon_animation_actor_add_keyframe (actor, HILDON_AA_ATTR_Y,
+                                         50, 100, HILDON_AA_EASE_LINEAR);
+    g_signal_connect (actor, "timeline-completed",
+                      G_CALLBACK (timeline_completed), &completed);
+
+    hildon_animation_actor_start_timeline (actor, FALSE);
+
+    fail_if (!hildon_animation_actor_is_timeline_running (actor),
+             "hildon-animation-actor: timeline not running after start");
+
+    timeout_id = g_timeout_add (5000, timeline_timeout, &timed_out);
+    while (!completed && !timed_out)
+        gtk_main_iteration ();
+    if (!timed_out)
+        g_source_remove (timeout_id);
+
+    fake_wm_process_events ();
+
+    fail_if (!completed,
+             "hildon-animation-actor: timeline-completed was not emitted");
+    fail_if (hildon_animation_actor_is_timeline_running (actor),
+             "hildon-animation-actor: timeline still running after completion");
+    last = last_message ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION");
+    fail_if (last == NULL,
+             "hildon-animation-actor: no position sent by the timeline");
+    fail_if (last->data[0] != 200 || last->data[1] != 100,
+             "hildon-animation-actor: timeline ended at (%ld, %ld)",
+             last->data[0], last->data[1]);
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_SCALE") != 0,
+             "hildon-animation-actor: unchanged scale was sent");
+}
+END_TEST
+
+/* ----- Test cases against the fake window manager -----*/
+
+/**
+ * Purpose: Check that an update reaches the window manager as a single
+ *          message per parameter.
+ */
+START_TEST (test_managed_update)
+{
+    gint i;
+
+    hildon_animation_actor_begin_update (actor);
+    for (i = 0; i < 10; i++)
+    {
+        hildon_animation_actor_set_position (actor, i, i);
+        hildon_animation_actor_set_scale (actor, 1 + i / 10.0, 1);
+    }
+    hildon_animation_actor_commit_update (actor);
+
+    fake_wm_process_events ();
+
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION") != 1,
+             "hildon-animation-actor: position was not sent exactly once");
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_SCALE") != 1,
+             "hildon-animation-actor: scale was not sent exactly once");
+    fail_if (fake_wm_get_messages ()->len != 2,
+             "hildon-animation-actor: unexpected messages sent by the update");
+}
+END_TEST
+
+/**
+ * Purpose: Check that timelines don't send messages faster than the
+ *          frame rate.
+ */
+START_TEST (test_managed_timeline_rate)
+{
+    gdouble rate;
+
+    hildon_animation_actor_add_keyframe (actor, HILDON_AA_ATTR_X,
+                                         500, 500, HILDON_AA_EASE_LINEAR);
+    hildon_animation_actor_start_timeline (actor, FALSE);
+
+    fake_wm_wait (600);
+
+    rate = fake_wm_get_message_rate ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION");
+
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION") < 2,
+             "hildon-animation-actor: timeline sent no intermediate positions");
+    fail_if (rate > 70,
+             "hildon-animation-actor: timeline sent %.1f positions per second",
+             rate);
+}
+END_TEST
+
+/**
+ * Purpose: Check that after a window manager restart the whole state is
+ *          sent again, geometry before parent and visibility.
+ */
+START_TEST (test_managed_restart)
+{
+    GArray *messages;
+    gint last_position = -1, first_parent = -1;
+    guint i;
+
+    hildon_animation_actor_set_position (actor, 10, 10);
+    fake_wm_clear_messages ();
+
+    /* A restarted window manager sets the ready property again */
+    fake_wm_manage (GTK_WIDGET (actor), "_HILDON_ANIMATION_CLIENT_READY");
+    fake_wm_wait (100);
+
+    messages = fake_wm_get_messages ();
+    for (i = 0; i < messages->len; i++)
+    {
+        FakeWMMessage *message = &g_array_index (messages, FakeWMMessage, i);
+
+        if (strcmp (message->type, "_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION") == 0)
+            last_position = i;
+        else if (strcmp (message->type, "_HILDON_ANIMATION_CLIENT_MESSAGE_PARENT") == 0 &&
+                 first_parent < 0)
+            first_parent = i;
+    }
+
+    fail_if (last_position < 0 || first_parent < 0,
+             "hildon-animation-actor: state not sent again after a restart");
+    fail_if (last_position > first_parent,
+             "hildon-animation-actor: parent sent before the geometry");
+    fail_if (fake_wm_count_messages ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION") != 1,
+             "hildon-animation-actor: position sent more than once");
+}
+END_TEST
+
+static void
+timeline_restart (HildonAnimationActor *self,
+                  gpointer user_data)
+{
+    gint *restarts = user_data;
+
+    if (*restarts > 0)
+    {
+        (*restarts)--;
+        hildon_animation_actor_start_timeline (self, FALSE);
+    }
+}
+
+/**
+ * Purpose: Check that restarting a timeline from its completed handler
+ *          doesn't leave more than one frame timeout running.
+ */
+START_TEST (test_managed_timeline_restart)
+{
+    gint restarts = 3;
+    gdouble rate;
+
+    hildon_animation_actor_add_keyframe (actor, HILDON_AA_ATTR_X,
+                                         200, 500, HILDON_AA_EASE_LINEAR);
+    g_signal_connect (actor, "timeline-completed",
+                      G_CALLBACK (timeline_restart), &restarts);
+    hildon_animation_actor_start_timeline (actor, FALSE);
+
+    fake_wm_wait (1000);
+
+    rate = fake_wm_get_message_rate ("_HILDON_ANIMATION_CLIENT_MESSAGE_POSITION");
+
+    fail_if (restarts != 0,
+             "hildon-animation-actor: timeline restarted %d times less than expected",
+             restarts);
+    fail_if (hildon_animation_actor_is_timeline_running (actor),
+             "hildon-animation-actor: timeline still running after the last restart");
+    fail_if (rate > 70,
+             "hildon-animation-actor: restarted timeline sent %.1f positions per second",
+             rate);
+}
+END_TEST
+
+/* ---------- Suite creation ---------- */
+
+Suite *create_hildon_animation_actor_suite (void)
+{
+    Suite *s = suite_create ("HildonAnimationActor");
+
+    TCase *tc1 = tcase_create ("update_coalescing");
+    TCase *tc2 = tcase_create ("timeline_keyframes");
+    TCase *tc3 = tcase_create ("managed_animation_actor");
+
+    tcase_add_checked_fixture (tc1, fx_setup_managed_animation_actor,
+                               fx_teardown_managed_animation_actor);
+    tcase_add_test (tc1, test_update_coalescing);
+    suite_add_tcase (s, tc1);
+
+    tcase_add_checked_fixture (tc2, fx_setup_managed_animation_actor,
+                               fx_teardown_managed_animation_actor);
+    tcase_add_test (tc2, test_timeline_keyframes);
+    suite_add_tcase (s, tc2);
+
+    tcase_add_checked_fixture (tc3, fx_setup_managed_animation_actor,
+                               fx_teardown_managed_animation_actor);
+    tcase_add_test (tc3, test_managed_update);
+    tcase_add_test (tc3, test_managed_timeline_rate);
+    tcase_add_test (tc3, test_managed_timeline_restart);
+    tcase_add_test (tc3, test_managed_restart);
+    suite_add_tcase (s, tc3);
+
+    return s;
+}
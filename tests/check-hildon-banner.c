@@ -24,6 +24,7 @@
 #ifndef HILDON_DISABLE_DEPRECATED
 
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <gtk/gtkmain.h>
 #include "test_suites.h"
@@ -216,6 +217,80 @@ START_TEST (test_show_progress_invalid)
 }
 END_TEST
 
+/* ----- Test case for set_update_interval -----*/
+
+static const gchar *
+get_banner_text (GtkWidget *widget)
+{
+  GList *children, *l;
+  const gchar *text = NULL;
+
+  if (GTK_IS_LABEL (widget))
+    return gtk_label_get_text (GTK_LABEL (widget));
+
+  if (!GTK_IS_CONTAINER (widget))
+    return NULL;
+
+  children = gtk_container_get_children (GTK_CONTAINER (widget));
+  for (l = children; l != NULL && text == NULL; l = l->next)
+    text = get_banner_text (GTK_WIDGET (l->data));
+  g_list_free (children);
+
+  return text;
+}
+
+static void
+wait_for_update (guint interval)
+{
+  g_usleep ((interval + 50) * 1000);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+/**
+ * Purpose: Check that texts arriving within the update interval are coalesced
+ * Cases considered:
+ *    - Show three information banners quickly with the replace policy.
+ *    - Show three information banners quickly with the merge policy.
+ */
+START_TEST (test_set_update_interval_regular)
+{
+  GtkWidget *banner;
+
+  /*Test 1: Only the last text is shown with the replace policy. */
+  banner = hildon_banner_show_information (b_window, NULL, "1/3");
+  hildon_banner_set_update_interval (HILDON_BANNER (banner), 100);
+
+  fail_if (hildon_banner_show_information (b_window, NULL, "2/3") != banner,
+           "hildon-banner: timed banner was not reused.");
+  hildon_banner_show_information (b_window, NULL, "3/3");
+
+  fail_if (strcmp (get_banner_text (banner), "1/3") != 0,
+           "hildon-banner: text was changed within the update interval.");
+
+  wait_for_update (100);
+  fail_if (strcmp (get_banner_text (banner), "3/3") != 0,
+           "hildon-banner: last text was not shown after the update interval.");
+
+  /*Test 2: All the texts are shown together with the merge policy. */
+  hildon_banner_set_update_policy (HILDON_BANNER (banner), HILDON_BANNER_UPDATE_MERGE);
+  wait_for_update (100);
+
+  hildon_banner_set_text (HILDON_BANNER (banner), "a");
+  hildon_banner_set_text (HILDON_BANNER (banner), "b");
+  hildon_banner_set_text (HILDON_BANNER (banner), "c");
+
+  fail_if (strcmp (get_banner_text (banner), "a") != 0,
+           "hildon-banner: text was changed within the update interval.");
+
+  wait_for_update (100);
+  fail_if (strcmp (get_banner_text (banner), "b\nc") != 0,
+           "hildon-banner: texts were not merged after the update interval.");
+
+  gtk_widget_destroy (banner);
+}
+END_TEST
+
 /* ---------- Suite creation ---------- */
 Suite *create_hildon_banner_suite()
 {
@@ -225,6 +300,7 @@ Suite *create_hildon_banner_suite()
   /* Create test cases */
   TCase *tc1 = tcase_create("show_animation");
   TCase *tc2 = tcase_create("show_progress");
+  TCase *tc3 = tcase_create("set_update_interval");
 
   /* Create unit tests for hildon_banner_show_animation and add it to the suite */
   tcase_add_checked_fixture(tc1, fx_setup_default_banner, fx_teardown_default_banner);
@@ -238,6 +314,11 @@ Suite *create_hildon_banner_suite()
   tcase_add_test(tc2, test_show_progress_invalid);
   suite_add_tcase (s, tc2);
 
+  /* Create unit tests for hildon_banner_set_update_interval and add it to the suite */
+  tcase_add_checked_fixture(tc3, fx_setup_default_banner, fx_teardown_default_banner);
+  tcase_add_test(tc3, test_set_update_interval_regular);
+  suite_add_tcase (s, tc3);
+
 
 
   /* Return created suite */
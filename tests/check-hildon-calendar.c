@@ -0,0 +1,147 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <stdlib.h>
+#include <check.h>
+#include <gtk/gtkmain.h>
+#include "test_suites.h"
+#include "check_utils.h"
+#include <hildon/hildon.h>
+
+#ifndef HILDON_DISABLE_DEPRECATED
+
+static HildonCalendar *calendar = NULL;
+
+static void
+fx_setup_default_calendar ()
+{
+    int argc = 0;
+
+    gtk_init (&argc, NULL);
+
+    calendar = HILDON_CALENDAR (hildon_calendar_new ());
+
+    fail_if (!HILDON_IS_CALENDAR (calendar),
+             "hildon-calendar: Creation failed.");
+
+    show_test_window (GTK_WIDGET (calendar));
+
+    hildon_calendar_select_month (calendar, 0, 2009);
+}
+
+static void
+fx_teardown_default_calendar ()
+{
+    gtk_widget_destroy (GTK_WIDGET (calendar));
+}
+
+/* Returns the marks shown by the calendar for the current month */
+static guint32
+shown_marks (void)
+{
+    guint32 days = 0;
+    gint day;
+
+    for (day = 0; day < 31; day++)
+        if (calendar->marked_date[day])
+            days |= 1 << day;
+
+    return days;
+}
+
+/* ----- Test case for set_marks/get_marks -----*/
+
+/**
+ * Purpose: Check that the marks of each month are kept and shown again
+ *          when the calendar changes month and year.
+ */
+START_TEST (test_marks_month_change)
+{
+    hildon_calendar_set_marks (calendar, 2009, 0, 1 << 0 | 1 << 30);
+    hildon_calendar_set_marks (calendar, 2009, 1, 1 << 13);
+    hildon_calendar_set_marks (calendar, 2010, 0, 1 << 4);
+
+    fail_if (shown_marks () != (1 << 0 | 1 << 30) || calendar->num_marked_dates != 2,
+             "hildon-calendar: wrong marks shown for the current month");
+
+    hildon_calendar_select_month (calendar, 1, 2009);
+    fail_if (shown_marks () != 1 << 13 || calendar->num_marked_dates != 1,
+             "hildon-calendar: wrong marks shown after changing the month");
+
+    hildon_calendar_select_month (calendar, 0, 2010);
+    fail_if (shown_marks () != 1 << 4 || calendar->num_marked_dates != 1,
+             "hildon-calendar: wrong marks shown after changing the year");
+
+    hildon_calendar_select_month (calendar, 0, 2011);
+    fail_if (shown_marks () != 0 || calendar->num_marked_dates != 0,
+             "hildon-calendar: marks shown for a month without marks");
+
+    hildon_calendar_select_month (calendar, 0, 2009);
+    fail_if (shown_marks () != (1 << 0 | 1 << 30),
+             "hildon-calendar: marks lost after changing the month back");
+}
+END_TEST
+
+/**
+ * Purpose: Check that marking days of the shown month updates the marks
+ *          of that month only.
+ */
+START_TEST (test_marks_mark_day)
+{
+    hildon_calendar_set_marks (calendar, 2009, 1, 1 << 13);
+
+    hildon_calendar_mark_day (calendar, 5);
+    hildon_calendar_unmark_day (calendar, 5);
+    hildon_calendar_mark_day (calendar, 20);
+
+    fail_if (hildon_calendar_get_marks (calendar, 2009, 0) != 1 << 19,
+             "hildon-calendar: marked day not stored for the current month");
+    fail_if (hildon_calendar_get_marks (calendar, 2009, 1) != 1 << 13,
+             "hildon-calendar: marking a day changed another month");
+    fail_if (hildon_calendar_get_marks (calendar, 2008, 0) != 0,
+             "hildon-calendar: marking a day changed another year");
+
+    hildon_calendar_clear_marks (calendar);
+    fail_if (hildon_calendar_get_marks (calendar, 2009, 0) != 0 ||
+             hildon_calendar_get_marks (calendar, 2009, 1) != 1 << 13,
+             "hildon-calendar: clearing the marks changed another month");
+}
+END_TEST
+
+/* ---------- Suite creation ---------- */
+
+Suite *create_hildon_calendar_suite (void)
+{
+    Suite *s = suite_create ("HildonCalendar");
+
+    TCase *tc1 = tcase_create ("marks");
+
+    tcase_add_checked_fixture (tc1, fx_setup_default_calendar,
+                               fx_teardown_default_calendar);
+    tcase_add_test (tc1, test_marks_month_change);
+    tcase_add_test (tc1, test_marks_mark_day);
+    suite_add_tcase (s, tc1);
+
+    return s;
+}
+
+#endif /* HILDON_DISABLE_DEPRECATED */
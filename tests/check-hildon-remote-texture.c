@@ -0,0 +1,177 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+#include <gtk/gtkmain.h>
+#include "test_suites.h"
+#include "check_utils.h"
+#include "fake_wm.h"
+#include <hildon/hildon.h>
+#include <hildon/hildon-remote-texture.h>
+
+#define DAMAGE_MESSAGE "_HILDON_TEXTURE_CLIENT_MESSAGE_DAMAGE"
+#define SHM_MESSAGE    "_HILDON_TEXTURE_CLIENT_MESSAGE_SHM"
+
+static HildonRemoteTexture *texture = NULL;
+static GtkWidget *window = NULL;
+
+static void
+fx_setup_managed_remote_texture ()
+{
+    int argc = 0;
+
+    gtk_init (&argc, NULL);
+
+    fail_if (!fake_wm_start (),
+             "hildon-remote-texture: could not start the fake WM");
+
+    window = create_test_window ();
+    show_test_window (window);
+
+    texture = HILDON_REMOTE_TEXTURE (hildon_remote_texture_new ());
+
+    fail_if (!HILDON_IS_REMOTE_TEXTURE (texture),
+             "hildon-remote-texture: Creation failed.");
+
+    hildon_remote_texture_set_parent (texture, GTK_WINDOW (window));
+    show_test_window (GTK_WIDGET (texture));
+
+    fake_wm_manage (GTK_WIDGET (texture), "_HILDON_TEXTURE_CLIENT_READY");
+    fake_wm_clear_messages ();
+}
+
+static void
+fx_teardown_managed_remote_texture ()
+{
+    gtk_widget_destroy (GTK_WIDGET (texture));
+    gtk_widget_destroy (window);
+    fake_wm_stop ();
+}
+
+/* ----- Test case for hildon_remote_texture_update_area -----*/
+
+/**
+ * Purpose: Check that distant damaged areas are reported separately and
+ *          close ones are merged, once per frame.
+ */
+START_TEST (test_update_area_rectangles)
+{
+    guint64 changed, reported;
+    gint i;
+
+    /* Opposite corners */
+    hildon_remote_texture_update_area (texture, 0, 0, 10, 10);
+    hildon_remote_texture_update_area (texture, 500, 300, 10, 10);
+    fake_wm_wait (50);
+
+    fail_if (fake_wm_count_messages (DAMAGE_MESSAGE) != 2,
+             "hildon-remote-texture: distant areas sent as %d messages",
+             fake_wm_count_messages (DAMAGE_MESSAGE));
+
+    hildon_remote_texture_get_damage_stats (texture, &changed, &reported);
+    fail_if (changed != 200 || reported != 200,
+             "hildon-remote-texture: wrong damage counters");
+
+    /* Overlapping updates in one frame */
+    fake_wm_clear_messages ();
+    for (i = 0; i < 10; i++)
+        hildon_remote_texture_update_area (texture, i, i, 20, 20);
+    fake_wm_wait (50);
+
+    fail_if (fake_wm_count_messages (DAMAGE_MESSAGE) != 1,
+             "hildon-remote-texture: overlapping areas sent as %d messages",
+             fake_wm_count_messages (DAMAGE_MESSAGE));
+}
+END_TEST
+
+/* ----- Test case for hildon_remote_texture_begin/end_frame -----*/
+
+/**
+ * Purpose: Check that every frame swaps the buffer shown, sending the
+ *          image and its damage together.
+ */
+START_TEST (test_buffered_frames)
+{
+    GArray *messages;
+    glong first_key = 0;
+    gint i;
+
+    fail_if (!hildon_remote_texture_create_buffers (texture, 64, 64, 4, 2),
+             "hildon-remote-texture: could not create buffers");
+
+    for (i = 0; i < 2; i++)
+    {
+        guchar *pixels = hildon_remote_texture_begin_frame (texture);
+
+        fail_if (pixels == NULL,
+                 "hildon-remote-texture: no buffer to draw the frame");
+        pixels[0] = i;
+        hildon_remote_texture_end_frame (texture);
+    }
+
+    fake_wm_process_events ();
+    messages = fake_wm_get_messages ();
+
+    fail_if (fake_wm_count_messages (SHM_MESSAGE) != 2,
+             "hildon-remote-texture: image not sent once per frame");
+    fail_if (fake_wm_count_messages (DAMAGE_MESSAGE) != 2,
+             "hildon-remote-texture: damage not sent once per frame");
+
+    for (i = 0; i < messages->len; i++)
+    {
+        FakeWMMessage *message = &g_array_index (messages, FakeWMMessage, i);
+
+        if (strcmp (message->type, SHM_MESSAGE) != 0)
+            continue;
+
+        if (first_key == 0)
+            first_key = message->data[0];
+        else
+            fail_if (message->data[0] == first_key,
+                     "hildon-remote-texture: buffers were not swapped");
+    }
+}
+END_TEST
+
+/* ---------- Suite creation ---------- */
+
+Suite *create_hildon_remote_texture_suite (void)
+{
+    Suite *s = suite_create ("HildonRemoteTexture");
+
+    TCase *tc1 = tcase_create ("update_area");
+    TCase *tc2 = tcase_create ("buffered_frames");
+
+    tcase_add_checked_fixture (tc1, fx_setup_managed_remote_texture,
+                               fx_teardown_managed_remote_texture);
+    tcase_add_test (tc1, test_update_area_rectangles);
+    suite_add_tcase (s, tc1);
+
+    tcase_add_checked_fixture (tc2, fx_setup_managed_remote_texture,
+                               fx_teardown_managed_remote_texture);
+    tcase_add_test (tc2, test_buffered_frames);
+    suite_add_tcase (s, tc2);
+
+    return s;
+}
@@ -64,6 +64,7 @@ configure_tests(gint environment)
   srunner_add_suite(sr, create_hildon_seekbar_suite());
   /* srunner_add_suite(sr, create_hildon_dialoghelp_suite()); */
   srunner_add_suite(sr, create_hildon_calendar_popup_suite());
+  srunner_add_suite(sr, create_hildon_calendar_suite());
   srunner_add_suite(sr, create_hildon_range_editor_suite());
   /* srunner_add_suite(sr, create_hildon_name_password_dialog_suite());
   srunner_add_suite(sr, create_hildon_get_password_dialog_suite());
@@ -87,6 +88,8 @@ configure_tests(gint environment)
   srunner_add_suite(sr, create_hildon_window_suite());
   srunner_add_suite(sr, create_hildon_helper_suite());
   srunner_add_suite(sr, create_hildon_picker_button_suite());
+  srunner_add_suite(sr, create_hildon_animation_actor_suite());
+  srunner_add_suite(sr, create_hildon_remote_texture_suite());
 
   /* Disable tests that need maemo environment to be up if it is not running */
   if (environment != ENVIRONMENT_MAEMO_ERROR)
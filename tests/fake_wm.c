@@ -0,0 +1,245 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <gtk/gtkmain.h>
+#include <gdk/gdkx.h>
+
+#include "fake_wm.h"
+
+static Display *display = NULL;
+static GArray *messages = NULL;
+static GTimer *timer = NULL;
+static guint watch_id = 0;
+
+/**
+ * Reads all the events received by the fake WM connection, recording
+ * the ClientMessages.
+ */
+static void
+read_events (void)
+{
+  while (XPending (display))
+    {
+      XEvent event;
+      FakeWMMessage message;
+      gchar *name;
+      gint i;
+
+      XNextEvent (display, &event);
+
+      if (event.type != ClientMessage)
+        continue;
+
+      name = XGetAtomName (display, event.xclient.message_type);
+
+      message.window = event.xclient.window;
+      message.type = g_strdup (name);
+      for (i = 0; i < 5; i++)
+        message.data[i] = event.xclient.data.l[i];
+      message.time = g_timer_elapsed (timer, NULL);
+
+      g_array_append_val (messages, message);
+      XFree (name);
+    }
+}
+
+static gboolean
+display_watch (GIOChannel *source, GIOCondition condition, gpointer data)
+{
+  read_events ();
+
+  return TRUE;
+}
+
+/**
+ * Opens the fake WM connection to the X server.
+ */
+gboolean
+fake_wm_start (void)
+{
+  GIOChannel *channel;
+
+  display = XOpenDisplay (gdk_display_get_name (gdk_display_get_default ()));
+  if (display == NULL)
+    return FALSE;
+
+  messages = g_array_new (FALSE, FALSE, sizeof (FakeWMMessage));
+  timer = g_timer_new ();
+
+  /* Timestamp the messages as soon as they arrive */
+  channel = g_io_channel_unix_new (ConnectionNumber (display));
+  watch_id = g_io_add_watch (channel, G_IO_IN, display_watch, NULL);
+  g_io_channel_unref (channel);
+
+  return TRUE;
+}
+
+void
+fake_wm_stop (void)
+{
+  if (display == NULL)
+    return;
+
+  g_source_remove (watch_id);
+  fake_wm_clear_messages ();
+  g_array_free (messages, TRUE);
+  g_timer_destroy (timer);
+  XCloseDisplay (display);
+  display = NULL;
+}
+
+/**
+ * Starts recording the messages sent by @widget and tells it that the
+ * fake WM is ready, by setting the @ready_atom property on its window.
+ */
+void
+fake_wm_manage (GtkWidget *widget, const gchar *ready_atom)
+{
+  Window window;
+  Atom atom;
+
+  gtk_widget_realize (widget);
+  window = GDK_WINDOW_XID (widget->window);
+  atom = XInternAtom (display, ready_atom, False);
+
+  XSelectInput (display, window, StructureNotifyMask);
+  XChangeProperty (display, window, atom, XA_ATOM, 32, PropModeReplace,
+                   (unsigned char *) &atom, 1);
+  XSync (display, False);
+
+  fake_wm_process_events ();
+}
+
+/**
+ * Lets the application process its pending events and the fake WM
+ * record the messages they produced.
+ */
+void
+fake_wm_process_events (void)
+{
+  do
+    {
+      gdk_flush ();
+      XSync (display, False);
+      read_events ();
+
+      while (gtk_events_pending ())
+        gtk_main_iteration ();
+
+      gdk_flush ();
+      XSync (display, False);
+    }
+  while (XPending (display));
+}
+
+static gboolean
+wait_timeout (gpointer data)
+{
+  *((gboolean *) data) = TRUE;
+
+  return FALSE;
+}
+
+/**
+ * Runs the main loop for @msecs milliseconds, so that timeouts in the
+ * application get to send their messages.
+ */
+void
+fake_wm_wait (guint msecs)
+{
+  gboolean done = FALSE;
+
+  g_timeout_add (msecs, wait_timeout, &done);
+
+  while (!done)
+    gtk_main_iteration ();
+
+  fake_wm_process_events ();
+}
+
+void
+fake_wm_clear_messages (void)
+{
+  guint i;
+
+  for (i = 0; i < messages->len; i++)
+    g_free (g_array_index (messages, FakeWMMessage, i).type);
+
+  g_array_set_size (messages, 0);
+}
+
+/**
+ * Returns the messages recorded since the last call to
+ * fake_wm_clear_messages(), in reception order.
+ */
+GArray *
+fake_wm_get_messages (void)
+{
+  return messages;
+}
+
+/**
+ * Counts the recorded messages whose type atom is named @type.
+ */
+guint
+fake_wm_count_messages (const gchar *type)
+{
+  guint i, n = 0;
+
+  for (i = 0; i < messages->len; i++)
+    if (strcmp (g_array_index (messages, FakeWMMessage, i).type, type) == 0)
+      n++;
+
+  return n;
+}
+
+/**
+ * Returns the rate, in messages per second, of the recorded messages
+ * of @type, measured between the first and the last one.
+ */
+gdouble
+fake_wm_get_message_rate (const gchar *type)
+{
+  gdouble first = -1, last = -1;
+  guint i, n = 0;
+
+  for (i = 0; i < messages->len; i++)
+    {
+      FakeWMMessage *message = &g_array_index (messages, FakeWMMessage, i);
+
+      if (strcmp (message->type, type) != 0)
+        continue;
+
+      if (first < 0)
+        first = message->time;
+      last = message->time;
+      n++;
+    }
+
+  if (n < 2 || last <= first)
+    return 0;
+
+  return (n - 1) / (last - first);
+}
@@ -0,0 +1,54 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef _FAKE_WM_H_
+#define _FAKE_WM_H_
+
+#include <gtk/gtkwidget.h>
+
+/*
+ * A stand-in for the parts of hildon-desktop that animation actors and
+ * remote textures talk to. It uses its own X connection to set the
+ * _HILDON_*_CLIENT_READY properties on the managed windows and to record
+ * the ClientMessages they send.
+ */
+
+typedef struct
+{
+  gulong  window;
+  gchar  *type;
+  glong   data[5];
+  gdouble time;      /* seconds since fake_wm_start() */
+} FakeWMMessage;
+
+gboolean  fake_wm_start             (void);
+void      fake_wm_stop              (void);
+void      fake_wm_manage            (GtkWidget   *widget,
+                                     const gchar *ready_atom);
+void      fake_wm_process_events    (void);
+void      fake_wm_wait              (guint        msecs);
+void      fake_wm_clear_messages    (void);
+GArray   *fake_wm_get_messages      (void);
+guint     fake_wm_count_messages    (const gchar *type);
+gdouble   fake_wm_get_message_rate  (const gchar *type);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * This file is a part of hildon tests
+ *
+ * Copyright (C) 2009 Nokia Corporation, all rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+/*
+
+ Micro-benchmark for the HildonColorChooser renderers. The widget source
+ is included to reach its static functions, so don't link with hildon:
+
+ gcc -O2 -I../hildon `pkg-config --cflags gtk+-2.0` -o tc_color_chooser_render \
+     tc_color_chooser_render.c `pkg-config --libs gtk+-2.0` && ./tc_color_chooser_render
+
+ Usage: tc_color_chooser_render [<width> <height> [<iterations>]]
+
+ The SV plane and hue bar are rendered with the old per-expose RGB
+ renderers (copied below) and with the current ones, which must produce
+ the same colors. The throughput of both is printed in Mpixels/s.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../hildon/hildon-color-chooser.c"
+
+static unsigned char *
+old_sv_plane (unsigned short hue, int sw, int sh)
+{
+    unsigned char *buf, *ptr;
+    unsigned long rgbx[3] = { 0x00ffffff, 0x00ffffff, 0x00ffffff }, rgbtmp[3];
+    signed long rgby[3];
+    int i, j;
+    int tmp = sw * sh;
+
+    buf = (unsigned char *) g_malloc (sw * sh * 3);
+    ptr = buf;
+
+    inline_h2rgb (hue, rgbtmp);
+
+    rgby[0] = rgbtmp[0] - rgbx[0];
+    rgby[1] = rgbtmp[1] - rgbx[1];
+    rgby[2] = rgbtmp[2] - rgbx[2];
+
+    rgbx[0] /= sw;
+    rgbx[1] /= sw;
+    rgbx[2] /= sw;
+
+    rgby[0] /= tmp;
+    rgby[1] /= tmp;
+    rgby[2] /= tmp;
+
+    for (i = 0; i < sh; i++) {
+        rgbtmp[0] = 0;
+        rgbtmp[1] = 0;
+        rgbtmp[2] = 0;
+
+        for (j = 0; j < sw; j++) {
+            ptr[0] = rgbtmp[0] >> 16;
+            ptr[1] = rgbtmp[1] >> 16;
+            ptr[2] = rgbtmp[2] >> 16;
+            rgbtmp[0] += rgbx[0];
+            rgbtmp[1] += rgbx[1];
+            rgbtmp[2] += rgbx[2];
+            ptr += 3;
+        }
+
+        rgbx[0] += rgby[0];
+        rgbx[1] += rgby[1];
+        rgbx[2] += rgby[2];
+    }
+
+    return buf;
+}
+
+static unsigned char *
+old_hue_bar (int w, int h)
+{
+    unsigned short hvec, hcurr;
+    unsigned char *buf, *ptr, tmp[3];
+    int i, j;
+
+    buf = (unsigned char *) g_malloc (w * h * 3);
+
+    hvec = 65535 / h;
+    hcurr = 0;
+    ptr = buf;
+
+    for (i = 0; i < h; i++) {
+        intern_h2rgb8 (hcurr, tmp);
+
+        for (j = 0; j < w; j++) {
+            ptr[0] = tmp[0];
+            ptr[1] = tmp[1];
+            ptr[2] = tmp[2];
+            ptr += 3;
+        }
+
+        hcurr += hvec;
+    }
+
+    return buf;
+}
+
+static int
+compare (const char *name, unsigned char *old, guint32 *new, int n_pixels)
+{
+    guint32 pixel;
+    int i;
+
+    for (i = 0; i < n_pixels; i++) {
+        pixel = PACK_RGB (old[i * 3], old[i * 3 + 1], old[i * 3 + 2]);
+
+        if (pixel != new[i]) {
+            fprintf (stderr, "%s: pixel %d differs: %08x, expected %08x\n",
+                     name, i, new[i], pixel);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void
+report (const char *name, GTimer *timer, double n_pixels)
+{
+    printf ("%-20s %8.1f Mpixels/s\n", name,
+            n_pixels / g_timer_elapsed (timer, NULL) / 1000000.0);
+}
+
+int main (int argc, char **argv)
+{
+    int width = 400, height = 300, iterations = 200;
+    unsigned char *old;
+    guint32 *new;
+    GTimer *timer;
+    int failed = 0;
+    int i;
+
+    if (argc >= 3) {
+        width = atoi (argv[1]);
+        height = atoi (argv[2]);
+    }
+    if (argc >= 4) {
+        iterations = atoi (argv[3]);
+    }
+
+    if (width <= 0 || height <= 0 || iterations <= 0) {
+        fprintf (stderr, "Invalid size or iteration count.\n");
+        return 1;
+    }
+
+    new = g_new (guint32, width * height);
+
+    /* Check that every hue renders as before */
+    for (i = 0; i < 0xffff; i += 97) {
+        old = old_sv_plane (i, width, height);
+        render_sv_plane (new, i, width, height, 0, 0, width, height);
+        failed |= compare ("sv plane", old, new, width * height);
+        g_free (old);
+
+        if (failed)
+            break;
+    }
+
+    old = old_hue_bar (width, height);
+    render_hue_bar (new, width, 0, height, height);
+    failed |= compare ("hue bar", old, new, width * height);
+    g_free (old);
+
+    timer = g_timer_new ();
+
+    for (i = 0; i < iterations; i++)
+        g_free (old_sv_plane (i * 300, width, height));
+    report ("old sv plane", timer, (double) width * height * iterations);
+
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++)
+        render_sv_plane (new, i * 300, width, height, 0, 0, width, height);
+    report ("sv plane", timer, (double) width * height * iterations);
+
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++)
+        g_free (old_hue_bar (width, height));
+    report ("old hue bar", timer, (double) width * height * iterations);
+
+    g_timer_start (timer);
+    for (i = 0; i < iterations; i++)
+        render_hue_bar (new, width, 0, height, height);
+    report ("hue bar", timer, (double) width * height * iterations);
+
+    g_timer_destroy (timer);
+    g_free (new);
+
+    return failed;
+}
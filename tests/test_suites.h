@@ -33,6 +33,7 @@ Suite *create_hildon_number_editor_suite(void);
 Suite *create_hildon_time_editor_suite(void);
 Suite *create_hildon_time_picker_suite(void);
 Suite *create_hildon_calendar_popup_suite(void);
+Suite *create_hildon_calendar_suite(void);
 Suite *create_hildon_weekday_picker_suite(void);
 Suite *create_hildon_controlbar_suite(void);
 Suite *create_hildon_color_button_suite(void);
@@ -63,5 +64,7 @@ Suite *create_hildon_window_suite(void);
 Suite *create_hildon_program_suite(void);
 Suite *create_hildon_composite_widget_suite(void);
 Suite *create_hildon_picker_button_suite (void);
+Suite *create_hildon_animation_actor_suite (void);
+Suite *create_hildon_remote_texture_suite (void);
 
 #endif